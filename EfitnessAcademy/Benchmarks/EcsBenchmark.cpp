@@ -0,0 +1,309 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// EntityManager and ParticleSystem micro-benchmarks
+//  runs without a window, times each operation at 1k, 10k, 100k and 1M
+//  entities, and a ParticleSystem update at 10k, 30k and 60k live particles,
+//  and writes ns/op, allocations/op and ops/s as JSON
+//
+//  EcsBenchmark [--out results.json] [--max 1000000] [--reps 5]
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "EntityManager.h"
+#include "ParticleSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+
+// every allocation in the process goes through here so the benchmarks can count them.
+//  All the replaced forms share one allocate and one release, so the compiler sees
+//  every delete paired with the new that made the pointer
+static std::atomic<size_t> g_allocations{ 0 };
+
+static void* countedAlloc(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+static void countedFree(void* p) noexcept
+{
+    std::free(p);
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t) noexcept { countedFree(p); }
+
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Result {
+        std::string     name;
+        size_t          entities;
+        double          nsPerOp;
+        double          allocsPerOp;
+        double          opsPerSec;
+    };
+
+    struct Sample {
+        double          ns{ 0 };
+        size_t          allocations{ 0 };
+        size_t          ops{ 0 };
+    };
+
+    // keeps the optimiser from dropping loops whose result is unused
+    volatile float g_sink{ 0.f };
+
+    const char* const Tags[] = { "player", "enemy", "bullet", "tile", "pickup", "effect", "npc", "ui" };
+    constexpr size_t TagCount = sizeof(Tags) / sizeof(Tags[0]);
+
+
+    // setup() builds the state and returns the op to time, the op returns how many ops it did
+    template<typename Setup>
+    Result measure(const std::string& name, size_t n, size_t reps, Setup&& setup)
+    {
+        std::vector<Sample> samples;
+        for (size_t r{ 0 }; r < reps; ++r) {
+            auto op = setup();
+
+            Sample s;
+            const size_t allocsBefore = g_allocations.load(std::memory_order_relaxed);
+            const auto start = Clock::now();
+            s.ops = op();
+            const auto stop = Clock::now();
+            s.allocations = g_allocations.load(std::memory_order_relaxed) - allocsBefore;
+            s.ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+            samples.push_back(s);
+        }
+
+        // median by time, its allocation count goes with it
+        std::sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) { return a.ns < b.ns; });
+        const Sample& m = samples[samples.size() / 2];
+        const double ops = static_cast<double>(std::max<size_t>(m.ops, 1));
+
+        Result result{ name, n, m.ns / ops, m.allocations / ops, ops * 1e9 / std::max(m.ns, 1.0) };
+        std::cerr << name << " n=" << n << "  " << result.nsPerOp << " ns/op  "
+            << result.allocsPerOp << " allocs/op  " << result.opsPerSec << " ops/s\n";
+        return result;
+    }
+
+
+    void populate(EntityManager& em, size_t n)
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> coord(0.f, 10000.f);
+        std::uniform_real_distribution<float> speed(-100.f, 100.f);
+
+        em.reserve(n);
+        for (size_t i{ 0 }; i < n; ++i) {
+            auto e = em.addEntity(Tags[i % TagCount]);
+            e->addComponent<CTransform>(sf::Vector2f(coord(rng), coord(rng)), sf::Vector2f(speed(rng), speed(rng)));
+            if (i % 2 == 0)
+                e->addComponent<CCollision>(8.f);
+            if (i % 4 == 0)
+                e->addComponent<CBoundingBox>(16.f, 16.f);
+        }
+        em.update();
+    }
+
+
+    void runSize(size_t n, size_t reps, std::vector<Result>& results)
+    {
+        // addEntity, including the update() that makes them live
+        results.push_back(measure("addEntity", n, reps, [n]() {
+            auto em = std::make_shared<EntityManager>();
+            return [em, n]() {
+                for (size_t i{ 0 }; i < n; ++i)
+                    em->addEntity(Tags[i % TagCount])->addComponent<CTransform>();
+                em->update();
+                return n;
+            };
+        }));
+
+        // update() after a fraction of the entities die and as many are spawned
+        for (const double rate : { 0.01, 0.1, 0.5 }) {
+            const std::string name = "update_death_" + std::to_string(static_cast<int>(rate * 100)) + "pct";
+            results.push_back(measure(name, n, reps, [n, rate]() {
+                auto em = std::make_shared<EntityManager>();
+                populate(*em, n);
+
+                std::mt19937 rng(42);
+                const size_t deaths = std::max<size_t>(1, static_cast<size_t>(n * rate));
+                EntityVec all = em->getEntities();
+                std::shuffle(all.begin(), all.end(), rng);
+                for (size_t i{ 0 }; i < deaths; ++i)
+                    em->get(all[i])->destroy();
+                for (size_t i{ 0 }; i < deaths; ++i)
+                    em->addEntity(Tags[i % TagCount])->addComponent<CTransform>();
+
+                return [em, deaths]() {
+                    em->update();
+                    return deaths;
+                };
+            }));
+        }
+
+        // tag look-ups by compile time hash, string and interned id
+        constexpr size_t Lookups{ 1'000'000 };
+        auto lookup = [n](auto&& get) {
+            return [n, get]() {
+                auto em = std::make_shared<EntityManager>();
+                populate(*em, n);
+                return [em, get]() {
+                    size_t total{ 0 };
+                    for (size_t i{ 0 }; i < Lookups; ++i)
+                        total += get(*em, i).size();
+                    g_sink = g_sink + static_cast<float>(total);
+                    return Lookups;
+                };
+            };
+        };
+
+        results.push_back(measure("getEntities_taghash", n, reps, lookup([](EntityManager& em, size_t i) -> const EntityVec& {
+            return (i & 1) ? em.getEntities("enemy"_tag) : em.getEntities("bullet"_tag);
+        })));
+        results.push_back(measure("getEntities_string", n, reps, lookup([](EntityManager& em, size_t i) -> const EntityVec& {
+            return em.getEntities(std::string_view(Tags[i % TagCount]));
+        })));
+        results.push_back(measure("getEntities_tagid", n, reps, lookup([](EntityManager& em, size_t i) -> const EntityVec& {
+            return em.getEntities(static_cast<TagId>(i % TagCount));
+        })));
+
+        // walking one pool
+        results.push_back(measure("iterate_single", n, reps, [n]() {
+            auto em = std::make_shared<EntityManager>();
+            populate(*em, n);
+            return [em]() {
+                float sum{ 0.f };
+                em->forEach<CTransform>([&sum](size_t, CTransform& t) { sum += t.pos.x + t.vel.y; });
+                g_sink = g_sink + sum;
+                return em->getPool<CTransform>().size();
+            };
+        }));
+
+        // a cached view over two pools
+        results.push_back(measure("iterate_multi", n, reps, [n]() {
+            auto em = std::make_shared<EntityManager>();
+            populate(*em, n);
+            em->view<CTransform, CCollision>();
+            return [em]() {
+                float sum{ 0.f };
+                auto view = em->view<CTransform, CCollision>();
+                view.each([&sum](Entity&, CTransform& t, CCollision& c) { sum += t.pos.x + c.radius; });
+                g_sink = g_sink + sum;
+                return view.size();
+            };
+        }));
+    }
+
+
+    // one ParticleSystem::update, spawning, moving, killing and building the quads,
+    // with the emitter at a steady state of about n live particles
+    void runParticles(size_t reps, std::vector<Result>& results)
+    {
+        constexpr size_t Frames{ 60 };
+        constexpr float Dt{ 1.f / 60.f };
+
+        for (const size_t n : { 10'000, 30'000, 60'000 }) {
+            results.push_back(measure("particle_update", n, reps, [n]() {
+                auto particles = std::make_shared<ParticleSystem>(n + n / 4);
+                EmitterDesc desc;
+                desc.spawnRadius = 50.f;
+                desc.radial = true;
+                desc.speedMin = 10.f;
+                desc.speedMax = 50.f;
+                desc.lifeMin = 1.5f;
+                desc.lifeMax = 2.5f;
+                desc.rate = static_cast<float>(n) / 2.f;
+                particles->addEmitter(desc);
+
+                // long enough for the first particles to have died
+                for (size_t f{ 0 }; f < 3 * Frames; ++f)
+                    particles->update(Dt);
+
+                return [particles]() {
+                    for (size_t f{ 0 }; f < Frames; ++f)
+                        particles->update(Dt);
+                    g_sink = g_sink + static_cast<float>(particles->liveCount());
+                    return Frames;
+                };
+            }));
+        }
+    }
+
+
+    void writeJson(std::ostream& os, const std::vector<Result>& results)
+    {
+        os << "{\n  \"results\": [\n";
+        for (size_t i{ 0 }; i < results.size(); ++i) {
+            const auto& r = results[i];
+            char line[256];
+            std::snprintf(line, sizeof(line),
+                "    { \"name\": \"%s\", \"entities\": %zu, \"ns_per_op\": %.3f, \"allocs_per_op\": %.4f, \"ops_per_sec\": %.1f }",
+                r.name.c_str(), r.entities, r.nsPerOp, r.allocsPerOp, r.opsPerSec);
+            os << line << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        os << "  ]\n}\n";
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::string outPath;
+    size_t maxEntities{ 1'000'000 };
+    size_t reps{ 5 };
+
+    for (int i{ 1 }; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc)
+            outPath = argv[++i];
+        else if (arg == "--max" && i + 1 < argc)
+            maxEntities = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--reps" && i + 1 < argc)
+            reps = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        else {
+            std::cerr << "usage: " << argv[0] << " [--out results.json] [--max entities] [--reps n]\n";
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    for (const size_t n : { 1'000, 10'000, 100'000, 1'000'000 })
+        if (n <= maxEntities)
+            runSize(n, reps, results);
+    runParticles(reps, results);
+
+    if (outPath.empty()) {
+        writeJson(std::cout, results);
+    }
+    else {
+        std::ofstream out(outPath);
+        if (out.fail()) {
+            std::cerr << "Open file " << outPath << " failed\n";
+            return 1;
+        }
+        writeJson(out, results);
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "AssetBundle.h"
+#include "Utilities.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+
+namespace {
+	uint64_t alignUp(uint64_t v)
+	{
+		return (v + bundle::Alignment - 1) & ~(bundle::Alignment - 1);
+	}
+
+	template<typename T>
+	void writeRaw(std::ofstream& out, const T& value)
+	{
+		out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+}
+
+
+bool AssetBundle::open(const std::string& path)
+{
+	_index = nullptr;
+	_count = 0;
+	_names = nullptr;
+	if (!_file.open(path))
+		return false;
+
+	// everything the index points at must be inside the file
+	const uint64_t size = _file.size();
+	const char* data = _file.data();
+	bundle::Header header;
+	if (size < sizeof(header))
+		return false;
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header.magic, bundle::Magic, sizeof(header.magic)) != 0 || header.version != bundle::Version)
+		return false;
+
+	const uint64_t indexEnd = header.indexOffset + uint64_t{ header.entryCount } * sizeof(bundle::Entry);
+	if (header.indexOffset % alignof(bundle::Entry) != 0 || indexEnd > size || header.namesOffset > size)
+		return false;
+
+	const auto* index = reinterpret_cast<const bundle::Entry*>(data + header.indexOffset);
+	for (uint32_t i{ 0 }; i < header.entryCount; ++i) {
+		const auto& e = index[i];
+		if (e.offset > size || e.size > size - e.offset
+			|| header.namesOffset + e.nameOffset + e.nameLength > size)
+			return false;
+	}
+
+	_index = index;
+	_count = header.entryCount;
+	_names = data + header.namesOffset;
+	_path = path;
+	return true;
+}
+
+std::string_view AssetBundle::name(const bundle::Entry& e) const
+{
+	return std::string_view(_names + e.nameOffset, e.nameLength);
+}
+
+std::string_view AssetBundle::find(std::string_view key) const
+{
+	const uint64_t hash = hashString(key);
+	const bundle::Entry* end = _index + _count;
+	auto e = std::lower_bound(_index, end, hash,
+		[](const bundle::Entry& entry, uint64_t h) { return entry.nameHash < h; });
+
+	for (; e != end && e->nameHash == hash; ++e) {
+		if (name(*e) == key)
+			return std::string_view(_file.data() + e->offset, static_cast<size_t>(e->size));
+	}
+	return {};
+}
+
+bool AssetBundle::contains(std::string_view key) const
+{
+	return find(key).data() != nullptr;
+}
+
+std::string_view AssetBundle::manifest() const
+{
+	return find(bundle::ManifestName);
+}
+
+size_t AssetBundle::size() const
+{
+	return _count;
+}
+
+const std::string& AssetBundle::path() const
+{
+	return _path;
+}
+
+
+bool BundleWriter::add(const std::string& name, std::vector<char> data)
+{
+	if (std::any_of(_blobs.begin(), _blobs.end(), [&name](const Blob& b) { return b.name == name; }))
+		return false;
+	_blobs.push_back(Blob{ name, std::move(data) });
+	return true;
+}
+
+bool BundleWriter::addFile(const std::string& name, const std::string& path)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (!in)
+		return false;
+	return add(name, std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()));
+}
+
+bool BundleWriter::write(const std::string& path) const
+{
+	bundle::Header header{};
+	std::memcpy(header.magic, bundle::Magic, sizeof(header.magic));
+	header.version = bundle::Version;
+	header.entryCount = static_cast<uint32_t>(_blobs.size());
+	header.indexOffset = sizeof(header);
+	header.namesOffset = header.indexOffset + _blobs.size() * sizeof(bundle::Entry);
+
+	// names first so the blob offsets are known, blobs stay in the order they were added
+	std::vector<bundle::Entry> index;
+	uint64_t names{ 0 };
+	for (const auto& b : _blobs) {
+		index.push_back(bundle::Entry{ hashString(b.name), 0, b.data.size(),
+			static_cast<uint32_t>(names), static_cast<uint32_t>(b.name.size()) });
+		names += b.name.size();
+	}
+	uint64_t offset = alignUp(header.namesOffset + names);
+	for (auto& e : index) {
+		e.offset = offset;
+		offset = alignUp(offset + e.size);
+	}
+
+	std::vector<bundle::Entry> sorted = index;
+	std::stable_sort(sorted.begin(), sorted.end(),
+		[](const bundle::Entry& a, const bundle::Entry& b) { return a.nameHash < b.nameHash; });
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out)
+		return false;
+
+	writeRaw(out, header);
+	for (const auto& e : sorted)
+		writeRaw(out, e);
+	for (const auto& b : _blobs)
+		out.write(b.name.data(), static_cast<std::streamsize>(b.name.size()));
+
+	static const char zeros[bundle::Alignment]{};
+	uint64_t at = header.namesOffset + names;
+	for (size_t i{ 0 }; i < _blobs.size(); ++i) {
+		out.write(zeros, static_cast<std::streamsize>(index[i].offset - at));
+		out.write(_blobs[i].data.data(), static_cast<std::streamsize>(_blobs[i].data.size()));
+		at = index[i].offset + index[i].size;
+	}
+	return static_cast<bool>(out);
+}
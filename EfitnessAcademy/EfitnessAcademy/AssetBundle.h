@@ -0,0 +1,85 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+// Asset bundle
+//  one file holding many assets, read through a memory mapping so a blob
+//  is handed to SFML's loadFromMemory without a copy or a file open.
+//
+//      | header | index, sorted by name hash | names | blobs, 64 byte aligned |
+//
+//  Blobs are named by the path the config used for them, so a Font or Texture
+//  line finds its file in an open bundle by its path. The blob named
+//  ManifestName holds config lines, the Font, Texture, Sound, Sprite and
+//  Animation directives the bundle was packed from. Little endian only.
+namespace bundle {
+	constexpr char			Magic[8]{ 'E', 'F', 'A', 'B', 'N', 'D', 'L', '\0' };
+	constexpr uint32_t		Version{ 1 };
+	constexpr uint64_t		Alignment{ 64 };
+	constexpr std::string_view	ManifestName{ "@manifest" };
+
+	struct Header {
+		char			magic[8];
+		uint32_t		version;
+		uint32_t		entryCount;
+		uint64_t		indexOffset;
+		uint64_t		namesOffset;
+	};
+
+	struct Entry {
+		uint64_t		nameHash;
+		uint64_t		offset;			// from the start of the file
+		uint64_t		size;
+		uint32_t		nameOffset;		// into the names block
+		uint32_t		nameLength;
+	};
+}
+
+
+class AssetBundle
+{
+private:
+	MappedFile					_file;
+	const bundle::Entry*		_index{ nullptr };
+	size_t						_count{ 0 };
+	const char*					_names{ nullptr };
+	std::string					_path;
+
+	std::string_view	name(const bundle::Entry& e) const;
+
+public:
+	// false if the file is missing, not a bundle or damaged
+	bool				open(const std::string& path);
+
+	// the blob, an empty view with a null data() when there is none by that name
+	std::string_view	find(std::string_view name) const;
+	bool				contains(std::string_view name) const;
+
+	std::string_view	manifest() const;
+	size_t				size() const;			// entries
+	const std::string&	path() const;
+};
+
+
+// writes a bundle, the blobs keep the order they were added in
+class BundleWriter
+{
+private:
+	struct Blob {
+		std::string			name;
+		std::vector<char>	data;
+	};
+	std::vector<Blob>		_blobs;
+
+public:
+	// false if there is already a blob by that name
+	bool				add(const std::string& name, std::vector<char> data);
+	bool				addFile(const std::string& name, const std::string& path);
+
+	bool				write(const std::string& path) const;
+};
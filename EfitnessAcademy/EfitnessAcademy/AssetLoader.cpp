@@ -0,0 +1,162 @@
+#include "AssetLoader.h"
+#include "Profiler.h"
+
+
+AssetLoader::~AssetLoader()
+{
+	cancel();
+}
+
+void AssetLoader::add(LoadedAsset::Kind kind, const std::string& name, const std::string& path,
+	std::string_view memory)
+{
+	auto asset = std::make_unique<LoadedAsset>();
+	asset->kind = kind;
+	asset->name = name;
+	asset->path = path;
+	asset->memory = memory;
+	_assets.push_back(std::move(asset));
+}
+
+void AssetLoader::addTask(const std::string& name, std::function<void()> task)
+{
+	auto asset = std::make_unique<LoadedAsset>();
+	asset->kind = LoadedAsset::Kind::Task;
+	asset->name = name;
+	asset->task = std::move(task);
+	_assets.push_back(std::move(asset));
+}
+
+// on a worker, nothing here may touch GL or the Assets maps
+void AssetLoader::decode(size_t index)
+{
+	if (_cancelled.load(std::memory_order_relaxed))
+		return;
+
+	LoadedAsset& asset = *_assets[index];
+	const void* memory = asset.memory.data();
+	const size_t size = asset.memory.size();
+	PROFILE_SCOPE("AssetDecode");
+	try {
+		switch (asset.kind) {
+		case LoadedAsset::Kind::Texture:
+			if (!(memory ? asset.image.loadFromMemory(memory, size) : asset.image.loadFromFile(asset.path)))
+				asset.error = "Could not load texture file: " + asset.path;
+			break;
+
+		case LoadedAsset::Kind::Font:
+			asset.font = std::make_unique<sf::Font>();
+			if (!(memory ? asset.font->loadFromMemory(memory, size) : asset.font->loadFromFile(asset.path)))
+				asset.error = "Load failed - " + asset.path;
+			break;
+
+		case LoadedAsset::Kind::Sound: {
+			sf::InputSoundFile file;
+			if (!(memory ? file.openFromMemory(memory, size) : file.openFromFile(asset.path))) {
+				asset.error = "Load failed - " + asset.path;
+				break;
+			}
+			asset.samples.resize(static_cast<size_t>(file.getSampleCount()));
+			asset.samples.resize(static_cast<size_t>(file.read(asset.samples.data(), asset.samples.size())));
+			asset.channelCount = file.getChannelCount();
+			asset.sampleRate = file.getSampleRate();
+			break;
+		}
+
+		case LoadedAsset::Kind::Task:
+			asset.task();
+			break;
+		}
+	}
+	catch (const std::exception& e) {
+		asset.error = e.what();
+	}
+
+	std::lock_guard<std::mutex> lock(_readyMutex);
+	_ready.push_back(index);
+}
+
+void AssetLoader::start(JobSystem* jobs)
+{
+	_jobs = jobs;
+	_started = true;
+	_ready.reserve(_assets.size());
+	for (size_t i{ 0 }; i < _assets.size(); ++i) {
+		if (_jobs)
+			_jobs->submit([this, i]() { decode(i); }, _counter);
+		else
+			decode(i);
+	}
+}
+
+bool AssetLoader::finishNext(const Finisher& finisher)
+{
+	size_t index;
+	{
+		std::lock_guard<std::mutex> lock(_readyMutex);
+		if (_readyNext == _ready.size())
+			return false;
+		index = _ready[_readyNext++];
+	}
+
+	LoadedAsset& asset = *_assets[index];
+	finisher(asset);
+	_current = asset.name;
+
+	// the decoded data is not needed once it is finished
+	_assets[index] = std::make_unique<LoadedAsset>();
+	_finished.fetch_add(1, std::memory_order_release);
+	return true;
+}
+
+bool AssetLoader::finish(sf::Time budget, const Finisher& finisher)
+{
+	PROFILE_FUNCTION();
+	sf::Clock clock;
+	do {
+		if (!finishNext(finisher))
+			break;
+	} while (clock.getElapsedTime() < budget);
+	return isDone();
+}
+
+void AssetLoader::finishAll(const Finisher& finisher)
+{
+	if (_jobs)
+		_jobs->wait(_counter);
+	while (finishNext(finisher))
+		;
+}
+
+void AssetLoader::cancel()
+{
+	_cancelled = true;
+	if (_started && _jobs)
+		_jobs->wait(_counter);
+	_jobs = nullptr;
+}
+
+size_t AssetLoader::total() const
+{
+	return _assets.size();
+}
+
+size_t AssetLoader::finished() const
+{
+	return _finished.load(std::memory_order_acquire);
+}
+
+float AssetLoader::progress() const
+{
+	return _assets.empty() ? 1.f : static_cast<float>(finished()) / static_cast<float>(_assets.size());
+}
+
+bool AssetLoader::isDone() const
+{
+	return _started && finished() == _assets.size();
+}
+
+const std::string& AssetLoader::current() const
+{
+	return _current;
+}
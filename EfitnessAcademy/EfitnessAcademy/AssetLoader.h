@@ -0,0 +1,92 @@
+#pragma once
+
+#include "JobSystem.h"
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+// one file read and decoded off the main thread, waiting to be finished on it
+struct LoadedAsset
+{
+	enum class Kind : uint8_t { Texture, Font, Sound, Task };
+
+	Kind						kind{ Kind::Texture };
+	std::string					name;
+	std::string					path;
+	std::string					error;			// empty when the decode worked
+	std::string_view			memory;			// decoded from here instead of path when set, must outlive the asset
+
+	sf::Image					image;			// Texture
+	std::unique_ptr<sf::Font>	font;			// Font, FreeType needs no GL context
+	std::vector<sf::Int16>		samples;		// Sound, the buffer is made on the main thread
+	unsigned int				channelCount{ 0 };
+	unsigned int				sampleRate{ 0 };
+	std::function<void()>		task;			// Task, runs on a worker as the decode
+};
+
+
+// Asynchronous asset loading
+//  start() hands every queued asset to the JobSystem, the workers read and
+//  decode the files in parallel. Whatever needs the GL context, texture
+//  uploads above all, is left for finish(), which the main thread calls once
+//  a frame with a time budget. Decoded assets are finished in the order the
+//  workers complete them. Without a JobSystem start() decodes everything
+//  on the calling thread.
+class AssetLoader
+{
+public:
+	using Finisher = std::function<void(LoadedAsset&)>;
+
+private:
+	std::vector<std::unique_ptr<LoadedAsset>>	_assets;
+	JobCounter						_counter;
+	JobSystem*						_jobs{ nullptr };
+
+	std::mutex						_readyMutex;
+	std::vector<size_t>				_ready;			// in the order they were decoded
+	size_t							_readyNext{ 0 };	// first one not finished
+	std::atomic<bool>				_cancelled{ false };
+	std::atomic<size_t>				_finished{ 0 };
+	std::string						_current;		// name of the last finished asset
+	bool							_started{ false };
+
+	void			decode(size_t index);
+	bool			finishNext(const Finisher& finisher);
+
+public:
+	AssetLoader() = default;
+	~AssetLoader();			// cancels what has not started decoding and waits for the rest
+
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator=(const AssetLoader&) = delete;
+
+	// queue before start
+	void			add(LoadedAsset::Kind kind, const std::string& name, const std::string& path,
+		std::string_view memory = {});
+	void			addTask(const std::string& name, std::function<void()> task);
+
+	void			start(JobSystem* jobs);
+
+	// hand decoded assets to finisher until the budget is spent, at least one
+	// per call, true once every asset is finished
+	bool			finish(sf::Time budget, const Finisher& finisher);
+
+	// block until everything is decoded, then finish all of it
+	void			finishAll(const Finisher& finisher);
+
+	// skip the decodes that have not started, waits for those that have
+	void			cancel();
+
+	size_t			total() const;
+	size_t			finished() const;
+	float			progress() const;		// 0 to 1
+	bool			isDone() const;
+	const std::string&	current() const;	// main thread only
+};
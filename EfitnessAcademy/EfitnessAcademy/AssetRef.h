@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace sf {
+    class Texture;
+    class SoundBuffer;
+}
+
+
+// Residency
+//  a texture or sound is known from its config line and resident while it is
+//  loaded. A resident entry nobody holds an AssetRef on may be evicted once
+//  resident memory is over budget, least recently used first, and is loaded
+//  again the next time it is asked for. Entries handed out by getTexture or
+//  getSound are pinned instead, the caller may keep a plain pointer to them.
+//  A texture first asked for off the main thread is decoded there and uploaded
+//  by the next collect(), until then it has no size and draws nothing.
+struct ResidentEntry {
+    std::string     path;
+    size_t          bytes{ 0 };         // while resident
+    uint32_t        refs{ 0 };
+    bool            pinned{ false };
+    bool            smooth{ true };     // textures
+    uint64_t        lastUse{ 0 };       // collect() frame of the last acquire or release
+
+    virtual ~ResidentEntry() = default;
+    virtual bool    isResident() const = 0;
+    virtual void    unload() = 0;
+    virtual void    retain() = 0;       // Assets counts the AssetRefs
+    virtual void    release() = 0;
+};
+
+
+// keeps a texture or sound resident while it is held, copies share the hold.
+// A held entry is never unloaded, so the asset stays where it is. Copying and
+// dropping one goes through the entry, a component holding one needs only
+// this header
+template<typename T>
+class AssetRef {
+private:
+    friend class Assets;
+    ResidentEntry*  _entry{ nullptr };
+    const T*        _asset{ nullptr };
+
+    AssetRef(ResidentEntry* entry, const T* asset) : _entry(entry), _asset(asset) {}   // the reference is already counted
+
+public:
+    AssetRef() = default;
+    AssetRef(const AssetRef& other) : _entry(other._entry), _asset(other._asset) {
+        if (_entry)
+            _entry->retain();
+    }
+    AssetRef(AssetRef&& other) noexcept
+        : _entry(std::exchange(other._entry, nullptr)), _asset(std::exchange(other._asset, nullptr)) {}
+    AssetRef& operator=(AssetRef other) noexcept {
+        std::swap(_entry, other._entry);
+        std::swap(_asset, other._asset);
+        return *this;
+    }
+    ~AssetRef() {
+        if (_entry)
+            _entry->release();
+    }
+
+    const T&        operator*() const { return *_asset; }
+    const T*        operator->() const { return _asset; }
+    const T*        get() const { return _asset; }
+    explicit operator bool() const { return _entry != nullptr; }
+};
+
+using TextureRef = AssetRef<sf::Texture>;
+using SoundRef = AssetRef<sf::SoundBuffer>;
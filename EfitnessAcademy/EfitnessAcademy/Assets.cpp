@@ -3,12 +3,50 @@
 //
 
 #include "Assets.h"
+#include "Components.h"
 #include "MusicPlayer.h"
 #include <iostream>
 #include <cassert>
-#include <fstream>
+#include <algorithm>
 
-Assets::Assets()
+namespace {
+    // collect() calls an entry has to be unused for, covers the snapshots of the pipelined mode
+    constexpr uint64_t EvictDelay{ 3 };
+
+    // the index bound to name, a new entry at the back of entries when there is none
+    template<typename Entries>
+    uint32_t slotFor(AssetNames& names, Entries& entries, const AssetName& name)
+    {
+        uint32_t index = names.find(name);
+        if (index == AssetNames::Invalid) {
+            index = static_cast<uint32_t>(entries.size());
+            entries.emplace_back();
+            names.bind(name, index);
+        }
+        return index;
+    }
+}
+
+
+uint32_t AssetNames::find(const AssetName& name) const
+{
+    auto found = _bound.find(name.hash);
+    if (found == _bound.end() || found->second.name != name.text)
+        return Invalid;     // a name never bound may have the hash of one that was
+    return found->second.index;
+}
+
+void AssetNames::bind(const AssetName& name, uint32_t index)
+{
+    auto [found, added] = _bound.try_emplace(name.hash, Bound{ index, std::string(name.text) });
+    if (!added && found->second.name != name.text)
+        throw std::runtime_error("Asset names " + found->second.name + " and " + std::string(name.text) + " have the same hash");
+    found->second.index = index;
+}
+
+
+// GameEngine asks for the instance first, on the main thread
+Assets::Assets() : _mainThread(std::this_thread::get_id())
 {}
 
 Assets& Assets::getInstance() {
@@ -16,228 +54,714 @@ Assets& Assets::getInstance() {
     return instance;
 }
 
+// the newest bundle wins, a null data() when no bundle has the file
+std::string_view Assets::findInBundles(const std::string& path) const
+{
+    for (auto b = _bundles.rbegin(); b != _bundles.rend(); ++b) {
+        const std::string_view blob = (*b)->find(path);
+        if (blob.data())
+            return blob;
+    }
+    return {};
+}
+
 void Assets::addFont(const std::string& fontName, const std::string& path) {
     std::unique_ptr<sf::Font> font(new sf::Font);
-    if (!font->loadFromFile(path))
+    const std::string_view blob = findInBundles(path);
+    if (!(blob.data() ? font->loadFromMemory(blob.data(), blob.size()) : font->loadFromFile(path)))
         throw std::runtime_error("Load failed - " + path);
 
-    auto rc = _fontMap.insert(std::make_pair(fontName, std::move(font)));
-    if (!rc.second) assert(0); // big problems if insert fails
+    auto& slot = _fonts[slotFor(_fontIds, _fonts, fontName)];
+    assert(!slot); // big problems if a font is added twice
+    slot = std::move(font);
 
     std::cout << "Loaded font: " << path << std::endl;
 }
 
 void Assets::addSound(const std::string& soundName, const std::string& path) {
-    std::unique_ptr<sf::SoundBuffer> sb(new sf::SoundBuffer);
-    if (!sb->loadFromFile(path))
-        throw std::runtime_error("Load failed - " + path);
-
-    auto rc = _soundEffects.insert(std::make_pair(soundName, std::move(sb)));
-    if (!rc.second) assert(0); // big problems if insert fails
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    auto& entry = _soundEffects[slotFor(_soundIds, _soundEffects, soundName)];
+    assert(!entry.isResident()); // big problems if a sound is added twice
+    entry.path = path;
+    makeResident(entry);
+}
 
-    std::cout << "Loaded sound effect: " << path << std::endl;
+void Assets::setHeadless(bool headless)
+{
+    _headless = headless;
 }
 
 void Assets::addTexture(const std::string& textureName, const std::string& path, bool smooth)
 {
-    _textures[textureName] = sf::Texture();
-    if (!_textures[textureName].loadFromFile(path)) {
-        std::cerr << "Could not load texture file: " << path << std::endl;
-        _textures.erase(textureName);
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    auto& entry = _textures[slotFor(_textureIds, _textures, textureName)];
+
+    // a held or pinned texture is pointed at by sprites and refs, it keeps what it was loaded from
+    if (entry.isResident() && (entry.refs > 0 || entry.pinned)) {
+        std::cerr << "Texture " << textureName << " is in use, not reloaded from " << path << std::endl;
+        return;
     }
-    else {
-        _textures.at(textureName).setSmooth(smooth);
-        std::cout << "Loaded texture: " << path << std::endl;
+    if (entry.isResident()) {
+        std::erase_if(_uploads, [&entry](const PendingUpload& upload) { return upload.entry == &entry; });
+        evict(entry);
+    }
+    entry.path = path;
+    entry.smooth = smooth;
+
+    // the entry stays, its id may be held, getTexture throws if it fails again
+    try {
+        makeResident(entry);
+    }
+    catch (const std::runtime_error&) {
+        std::cerr << "Could not load texture file: " << path << std::endl;
     }
 }
 
 void Assets::addSpriteRec(const std::string& name, SpriteRec sr)
 {
-    _spriteRecs[name] = sr;
+    // rects into a packed texture are moved onto its page, clipped to what trimming kept
+    if (const AtlasEntry* entry = _atlas ? _atlas->find(sr.texName) : nullptr) {
+        sr.texName = TextureAtlas::pageName(entry->page);
+        sr.texRect.left += entry->origin().x;
+        sr.texRect.top += entry->origin().y;
+        sf::IntRect clipped;
+        sr.texRect.intersects(entry->rect, clipped);
+        sr.texRect = clipped;
+    }
+    sr.texture = textureId(sr.texName);
+    _spriteRecs[slotFor(_spriteIds, _spriteRecs, name)] = std::move(sr);
 }
 
 void Assets::addAnimationRec(const std::string& name, AnimationRec ar)
 {
-    _animationRecs[name] = ar;
+    if (const AtlasEntry* entry = _atlas ? _atlas->find(ar.texName) : nullptr) {
+        ar.texName = TextureAtlas::pageName(entry->page);
+        ar.origin += entry->origin();
+    }
+    ar.texture = textureId(ar.texName);
+    _animationRecs[slotFor(_animIds, _animationRecs, name)] = std::move(ar);
+}
+
+FontId Assets::fontId(AssetName name) const
+{
+    return FontId{ _fontIds.find(name) };
 }
 
-const sf::Font& Assets::getFont(const std::string& fontName) const {
-    auto found = _fontMap.find(fontName);
-    assert(found != _fontMap.end());
-    return *found->second;
+// textures and sounds are added by the main thread while scenes resolve on the simulation thread
+SoundId Assets::soundId(AssetName name) const
+{
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    return SoundId{ _soundIds.find(name) };
 }
 
-const sf::SoundBuffer& Assets::getSound(const std::string& soundName) const {
-    auto found = _soundEffects.find(soundName);
-    assert(found != _soundEffects.end());
-    return *found->second;
+TextureId Assets::textureId(AssetName name) const
+{
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    return TextureId{ _textureIds.find(name) };
 }
 
-const sf::Texture& Assets::getTexture(const std::string& textureName) const
+SpriteId Assets::spriteId(AssetName name) const
 {
-    if (_textures.find(textureName) == _textures.end()) {
-        std::cerr << "Texture not found " << textureName;
-        throw std::out_of_range("Texture not found " + textureName);
-    }
-    return _textures.at(textureName);
+    return SpriteId{ _spriteIds.find(name) };
 }
 
-const SpriteRec& Assets::getSpriteRec(const std::string& name) const
+AnimId Assets::animId(AssetName name) const
 {
-    return _spriteRecs.at(name);
+    return AnimId{ _animIds.find(name) };
 }
 
-const AnimationRec& Assets::getAnimationRec(const std::string& name) const
+const sf::Font& Assets::getFont(FontId id) const
 {
-    return _animationRecs.at(name);
+    assert(id.index < _fonts.size());
+    return *_fonts[id.index];
 }
 
-void Assets::loadFonts(const std::string& path)
+const sf::Font& Assets::getFont(AssetName fontName) const
 {
-    std::ifstream confFile(path);
-    if (confFile.fail()) {
-        std::cerr << "Open file " << path << " failed\n";
-        confFile.close();
-        exit(1);
+    return getFont(fontId(fontName));
+}
+
+// the caller holds _residencyMutex
+void Assets::setResident(ResidentEntry& entry, size_t bytes)
+{
+    entry.bytes = bytes;
+    entry.lastUse = _frame;
+    _residentBytes += bytes;
+    if (entry.refs == 0 && !entry.pinned)
+        _idleBytes += bytes;
+    ++_loads;
+}
+
+// the caller holds _residencyMutex
+Resident<sf::Texture>& Assets::textureEntry(TextureId id)
+{
+    if (id.index >= _textures.size()) {
+        std::cerr << "Texture not found " << id.index;
+        throw std::out_of_range("Texture not found");
     }
+    return _textures[id.index];
+}
 
-    std::string token{ "" };
-    confFile >> token;
-    while (confFile) {
-        if (token == "Font") {
-            std::string name, path;
-            confFile >> name >> path;
-            addFont(name, path);
-        }
-        else {
-            // ignore rest of line and continue
-            std::string buffer;
-            std::getline(confFile, buffer);
+Resident<sf::SoundBuffer>& Assets::soundEntry(SoundId id)
+{
+    assert(id.index < _soundEffects.size());
+    return _soundEffects[id.index];
+}
+
+// headless gets an empty texture, there is no GL context to upload to. Off the
+// main thread the image is decoded here and the texture stays empty until
+// collect() uploads it, the GL context belongs to the main thread. The main
+// thread asking for it before then uploads it at once
+void Assets::makeResident(Resident<sf::Texture>& entry)
+{
+    if (entry.isResident()) {
+        if (!_uploads.empty() && std::this_thread::get_id() == _mainThread)
+            uploadPending(&entry);
+        return;
+    }
+
+    auto texture = std::make_unique<sf::Texture>();
+    size_t bytes{ 0 };
+    if (!_headless) {
+        sf::Image image;
+        const std::string_view blob = findInBundles(entry.path);
+        if (!(blob.data() ? image.loadFromMemory(blob.data(), blob.size()) : image.loadFromFile(entry.path)))
+            throw std::runtime_error("Load failed - " + entry.path);
+        bytes = size_t{ image.getSize().x } * image.getSize().y * 4;
+
+        if (std::this_thread::get_id() == _mainThread) {
+            if (!texture->loadFromImage(image))
+                throw std::runtime_error("Load failed - " + entry.path);
+            texture->setSmooth(entry.smooth);
+            std::cout << "Loaded texture: " << entry.path << std::endl;
         }
-        confFile >> token;
+        else
+            _uploads.push_back(PendingUpload{ &entry, std::move(image) });
     }
-    confFile.close();
+
+    entry.asset = std::move(texture);
+    setResident(entry, bytes);
+}
+
+void Assets::makeResident(Resident<sf::SoundBuffer>& entry)
+{
+    if (entry.isResident())
+        return;
+
+    auto sb = std::make_unique<sf::SoundBuffer>();
+    const std::string_view blob = findInBundles(entry.path);
+    if (!(blob.data() ? sb->loadFromMemory(blob.data(), blob.size()) : sb->loadFromFile(entry.path)))
+        throw std::runtime_error("Load failed - " + entry.path);
+    std::cout << "Loaded sound effect: " << entry.path << std::endl;
+
+    const size_t bytes = static_cast<size_t>(sb->getSampleCount()) * sizeof(sf::Int16);
+    entry.asset = std::move(sb);
+    setResident(entry, bytes);
 }
 
-void Assets::loadTextures(const std::string& path)
+const sf::SoundBuffer& Assets::getSound(SoundId id)
 {
-    // Read Config file
-    std::ifstream confFile(path);
-    if (confFile.fail()) {
-        std::cerr << "Open file: " << path << " failed\n";
-        confFile.close();
-        exit(1);
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    auto& entry = soundEntry(id);
+    makeResident(entry);
+    pin(entry);
+    return *entry.asset;
+}
+
+const sf::SoundBuffer& Assets::getSound(AssetName soundName)
+{
+    return getSound(soundId(soundName));
+}
+
+const sf::Texture& Assets::getTexture(TextureId id)
+{
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    auto& entry = textureEntry(id);
+    makeResident(entry);
+    pin(entry);
+    return *entry.asset;
+}
+
+const sf::Texture& Assets::getTexture(AssetName textureName)
+{
+    const TextureId id = textureId(textureName);
+    if (!id.isValid()) {
+        std::cerr << "Texture not found " << textureName.text;
+        throw std::out_of_range("Texture not found " + std::string(textureName.text));
     }
+    return getTexture(id);
+}
+
+sf::IntRect Assets::getTextureRect(AssetName textureName)
+{
+    if (const AtlasEntry* entry = _atlas ? _atlas->find(std::string(textureName.text)) : nullptr)
+        return entry->rect;
+
+    const TextureId id = textureId(textureName);
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    auto& entry = textureEntry(id);
+    makeResident(entry);
+    sf::Vector2u size = entry.asset->getSize();
+    for (const auto& upload : _uploads) {
+        if (upload.entry == &entry)
+            size = upload.image.getSize();      // not uploaded yet
+    }
+    return sf::IntRect(0, 0, static_cast<int>(size.x), static_cast<int>(size.y));
+}
+
+TextureRef Assets::acquireTexture(TextureId id)
+{
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    auto& entry = textureEntry(id);
+    makeResident(entry);
+    hold(entry);
+    entry.lastUse = _frame;
+    return TextureRef(&entry, entry.asset.get());
+}
+
+TextureRef Assets::acquireTexture(AssetName textureName)
+{
+    return acquireTexture(textureId(textureName));
+}
+
+SoundRef Assets::acquireSound(SoundId id)
+{
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    auto& entry = soundEntry(id);
+    makeResident(entry);
+    hold(entry);
+    entry.lastUse = _frame;
+    return SoundRef(&entry, entry.asset.get());
+}
+
+SoundRef Assets::acquireSound(AssetName soundName)
+{
+    return acquireSound(soundId(soundName));
+}
+
+CSprite Assets::makeSprite(SpriteId id)
+{
+    const SpriteRec& rec = getSpriteRec(id);
+    return CSprite(acquireTexture(rec.texture), rec.texRect);
+}
+
+CSprite Assets::makeSprite(AnimId id)
+{
+    const AnimationRec& rec = getAnimationRec(id);
+    return CSprite(acquireTexture(rec.texture), sf::IntRect(rec.origin, rec.frameSize));
+}
+
+CAnimation Assets::makeAnimation(AnimId id) const
+{
+    const AnimationRec& rec = getAnimationRec(id);
+    CAnimation anim;
+    anim.frameSize = rec.frameSize;
+    anim.numbFrames = rec.numbFrames;
+    anim.timePerFrame = rec.numbFrames ? rec.duration / static_cast<sf::Int64>(rec.numbFrames) : sf::Time::Zero;
+    anim.countDown = anim.timePerFrame;
+    anim.isRepeat = rec.repeat;
+    anim.origin = rec.origin;
+    return anim;
+}
+
+void Assets::retain(ResidentEntry& entry)
+{
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    hold(entry);
+}
+
+void Assets::release(ResidentEntry& entry)
+{
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    if (--entry.refs == 0 && !entry.pinned)
+        _idleBytes += entry.bytes;
+    entry.lastUse = _frame;
+}
+
+// the caller holds _residencyMutex for these, they keep _idleBytes to what collect() may evict
+void Assets::hold(ResidentEntry& entry)
+{
+    if (entry.refs++ == 0 && !entry.pinned)
+        _idleBytes -= entry.bytes;
+}
 
-    std::string token{ "" };
-    confFile >> token;
-    while (confFile) {
-        if (token == "Texture") {
-            std::string name, path;
-            confFile >> name >> path;
-            addTexture(name, path);
+void Assets::pin(ResidentEntry& entry)
+{
+    if (!entry.pinned && entry.refs == 0)
+        _idleBytes -= entry.bytes;
+    entry.pinned = true;
+}
+
+void Assets::evict(ResidentEntry& entry)
+{
+    _residentBytes -= entry.bytes;
+    if (entry.refs == 0 && !entry.pinned)
+        _idleBytes -= entry.bytes;
+    entry.unload();
+}
+
+// only's upload, or all of them. A texture that fails to upload stays empty,
+// its sprites draw nothing
+void Assets::uploadPending(const Resident<sf::Texture>* only)
+{
+    std::erase_if(_uploads, [only](PendingUpload& upload) {
+        if (only && upload.entry != only)
+            return false;
+
+        sf::Texture& texture = *upload.entry->asset;
+        if (!texture.loadFromImage(upload.image)) {
+            std::cerr << "Could not load texture file: " << upload.entry->path << std::endl;
+            return true;
         }
-        else {
-            // ignore rest of line and continue
-            std::string buffer;
-            std::getline(confFile, buffer);
+        texture.setSmooth(upload.entry->smooth);
+        std::cout << "Loaded texture: " << upload.entry->path << std::endl;
+        return true;
+    });
+}
+
+void Assets::collect()
+{
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    uploadPending();
+    ++_frame;
+
+    // held and pinned entries never go, with nothing else resident there is nothing to look through
+    if (_budgetBytes == 0 || _residentBytes <= _budgetBytes || _idleBytes == 0)
+        return;
+
+    // a snapshot in flight may still draw what was let go in the last frames
+    std::vector<ResidentEntry*> idle;
+    auto gather = [this, &idle](auto& entries) {
+        for (auto& entry : entries) {
+            if (entry.isResident() && entry.refs == 0 && !entry.pinned && _frame - entry.lastUse >= EvictDelay)
+                idle.push_back(&entry);
         }
-        confFile >> token;
+    };
+    gather(_textures);
+    gather(_soundEffects);
+
+    std::sort(idle.begin(), idle.end(), [](const ResidentEntry* a, const ResidentEntry* b) { return a->lastUse < b->lastUse; });
+    for (ResidentEntry* entry : idle) {
+        if (_residentBytes <= _budgetBytes)
+            break;
+        evict(*entry);
+        ++_evictions;
     }
-    confFile.close();
 }
 
-void Assets::loadSounds(const std::string& path)
+ResidencyStats Assets::residency() const
 {
-    std::ifstream confFile(path);
-    if (confFile.fail()) {
-        std::cerr << "Open file " << path << " failed\n";
-        confFile.close();
-        exit(1);
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    ResidencyStats stats;
+    auto count = [&stats](const ResidentEntry& entry) {
+        stats.referenced += entry.refs > 0;
+        stats.pinned += entry.pinned;
+    };
+    for (const auto& entry : _textures) {
+        stats.textures++;
+        stats.residentTextures += entry.isResident();
+        count(entry);
+    }
+    for (const auto& entry : _soundEffects) {
+        stats.sounds++;
+        stats.residentSounds += entry.isResident();
+        count(entry);
     }
+    stats.residentBytes = _residentBytes;
+    stats.budgetBytes = _budgetBytes;
+    stats.loads = _loads;
+    stats.evictions = _evictions;
+    return stats;
+}
+
+const SpriteRec& Assets::getSpriteRec(SpriteId id) const
+{
+    return _spriteRecs.at(id.index);
+}
+
+const SpriteRec& Assets::getSpriteRec(AssetName name) const
+{
+    return getSpriteRec(spriteId(name));
+}
+
+const AnimationRec& Assets::getAnimationRec(AnimId id) const
+{
+    return _animationRecs.at(id.index);
+}
 
-    std::string token{ "" };
-    confFile >> token;
-    while (confFile) {
-        if (token == "Sound") {
-            std::string name, path;
-            confFile >> name >> path;
-            addSound(name, path);
+const AnimationRec& Assets::getAnimationRec(AssetName name) const
+{
+    return getAnimationRec(animId(name));
+}
+
+// a name given again, by a bundle manifest and the config say, takes the later path
+void Assets::addPendingFile(LoadedAsset::Kind kind, const std::string& name, const std::string& path)
+{
+    for (auto& file : _pendingFiles) {
+        if (file.kind == kind && file.name == name) {
+            file.path = path;
+            return;
         }
-        else {
-            // ignore rest of line and continue
-            std::string buffer;
-            std::getline(confFile, buffer);
+    }
+    _pendingFiles.push_back(PendingFile{ kind, name, path });
+}
+
+void Assets::registerLazy(const PendingFile& file)
+{
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    if (file.kind == LoadedAsset::Kind::Texture)
+        _textures[slotFor(_textureIds, _textures, file.name)].path = file.path;
+    else
+        _soundEffects[slotFor(_soundIds, _soundEffects, file.name)].path = file.path;
+}
+
+void Assets::addConfigDirectives(ConfigParser& parser)
+{
+    parser.on("Residency", [this](ConfigLine& line) {
+        _budgetBytes = line.read<size_t>("budget in MB") * 1024 * 1024;
+        _lazy = line.read<bool>("lazy flag");
+    });
+
+    // the bundle's manifest is read as if its lines were here, its files are
+    // found by path from then on, also for lines outside the manifest
+    parser.on("Bundle", [this, &parser](ConfigLine& line) {
+        const std::string path = line.read<std::string>("bundle path");
+        auto bundle = std::make_unique<AssetBundle>();
+        if (!bundle->open(path))
+            throw line.error("not a bundle, or missing: " + path);
+
+        _bundles.push_back(std::move(bundle));
+        std::cout << "Opened bundle: " << path << " (" << _bundles.back()->size() << " entries)" << std::endl;
+        parser.parse(_bundles.back()->manifest(), path);
+    });
+
+    // files are only collected here, finishConfig loads them
+    parser.on("Font", [this](ConfigLine& line) {
+        const std::string name = line.read<std::string>("font name");
+        addPendingFile(LoadedAsset::Kind::Font, name, line.read<std::string>("font path"));
+    });
+
+    parser.on("Sound", [this](ConfigLine& line) {
+        const std::string name = line.read<std::string>("sound name");
+        addPendingFile(LoadedAsset::Kind::Sound, name, line.read<std::string>("sound path"));
+    });
+
+    parser.on("Atlas", [this](ConfigLine& line) {
+        AtlasSettings settings;
+        settings.pageSize = line.read<unsigned int>("page size");
+        settings.padding = line.read<unsigned int>("padding");
+        settings.trim = line.read<bool>("trim");
+        settings.cachePath = line.read<std::string>("cache path");
+        if (settings.cachePath == "-")
+            settings.cachePath.clear();
+
+        // headless has no GL context to upload pages to, textures stay placeholders
+        if (!_headless) {
+            settings.pageSize = std::min(settings.pageSize, sf::Texture::getMaximumSize());
+            _atlas = std::make_unique<TextureAtlas>(settings);
         }
-        confFile >> token;
+    });
+
+    // textures and records wait for the end of the file, an Atlas line may come after them
+    parser.on("Texture", [this](ConfigLine& line) {
+        const std::string name = line.read<std::string>("texture name");
+        addPendingFile(LoadedAsset::Kind::Texture, name, line.read<std::string>("texture path"));
+    });
+
+    parser.on("Sprite", [this](ConfigLine& line) {
+        const std::string name = line.read<std::string>("sprite name");
+        SpriteRec sr;
+        sr.texName = line.read<std::string>("texture name");
+        sr.texRect.left = line.read<int>("left");
+        sr.texRect.top = line.read<int>("top");
+        sr.texRect.width = line.read<int>("width");
+        sr.texRect.height = line.read<int>("height");
+        _pendingSprites.emplace_back(name, std::move(sr));
+    });
+
+    parser.on("Animation", [this](ConfigLine& line) {
+        const std::string name = line.read<std::string>("animation name");
+        AnimationRec ar;
+        ar.texName = line.read<std::string>("texture name");
+        ar.frameSize.x = line.read<int>("frame width");
+        ar.frameSize.y = line.read<int>("frame height");
+        ar.numbFrames = line.read<size_t>("frame count");
+        ar.duration = sf::seconds(line.read<float>("duration"));
+        ar.repeat = line.read<bool>("repeat");
+        _pendingAnimations.emplace_back(name, std::move(ar));
+    });
+}
+
+void Assets::finishConfig(JobSystem* jobs)
+{
+    _loader = std::make_unique<AssetLoader>();
+    for (const auto& file : _pendingFiles) {
+        const std::string_view blob = findInBundles(file.path);
+        const bool packed = file.kind == LoadedAsset::Kind::Texture && _atlas;
+        const bool resident = file.kind == LoadedAsset::Kind::Texture || file.kind == LoadedAsset::Kind::Sound;
+
+        // lazy entries only remember their path, headless has no textures to decode
+        if (packed)
+            _atlas->addSource(file.name, file.path, blob);
+        else if (resident && (_lazy || (_headless && file.kind == LoadedAsset::Kind::Texture)))
+            registerLazy(file);
+        else
+            _loader->add(file.kind, file.name, file.path, blob);
     }
-    confFile.close();
+    _pendingFiles.clear();
+
+    if (_atlas)
+        _loader->addTask("atlas", [this, jobs]() { _atlas->build(jobs); });
+
+    _loadTotal = _loader->total();
+    _loadFinished = 0;
+    _loading = true;
+    _loader->start(jobs);
+    if (!jobs)
+        finishLoading();
 }
 
-void Assets::loadSpriteRecs(const std::string& path)
+// on the main thread, the GL context is needed for textures. Runs inside a
+// frame, so a file that failed is reported and left out rather than thrown
+void Assets::finishLoaded(LoadedAsset& asset)
 {
-    std::ifstream confFile(path);
-    if (confFile.fail()) {
-        std::cerr << "Open file " << path << " failed\n";
-        confFile.close();
-        exit(1);
+    if (!asset.error.empty()) {
+        std::cerr << asset.error << std::endl;
+        return;
     }
 
-    std::string token{ "" };
-    confFile >> token;
-    while (confFile) {
-        if (token == "Sprite") {
-            std::string name;
-            SpriteRec sr;
-            confFile >> name >> sr.texName >> sr.texRect.left
-                >> sr.texRect.top >> sr.texRect.width >> sr.texRect.height;
-            addSpriteRec(name, sr);
+    switch (asset.kind) {
+    case LoadedAsset::Kind::Texture: {
+        std::lock_guard<std::mutex> lock(_residencyMutex);
+        auto texture = std::make_unique<sf::Texture>();
+        if (!texture->loadFromImage(asset.image)) {
+            std::cerr << "Could not load texture file: " << asset.path << std::endl;
+            return;
         }
-        else {
-            // ignore rest of line and continue
-            std::string buffer;
-            std::getline(confFile, buffer);
+        texture->setSmooth(true);
+        auto& entry = _textures[slotFor(_textureIds, _textures, asset.name)];
+        entry.path = asset.path;
+        entry.asset = std::move(texture);
+        setResident(entry, size_t{ asset.image.getSize().x } * asset.image.getSize().y * 4);
+        std::cout << "Loaded texture: " << asset.path << std::endl;
+        break;
+    }
+
+    case LoadedAsset::Kind::Font: {
+        auto& slot = _fonts[slotFor(_fontIds, _fonts, asset.name)];
+        assert(!slot); // big problems if a font is added twice
+        slot = std::move(asset.font);
+        std::cout << "Loaded font: " << asset.path << std::endl;
+        break;
+    }
+
+    case LoadedAsset::Kind::Sound: {
+        std::lock_guard<std::mutex> lock(_residencyMutex);
+        auto sb = std::make_unique<sf::SoundBuffer>();
+        if (!sb->loadFromSamples(asset.samples.data(), asset.samples.size(), asset.channelCount, asset.sampleRate)) {
+            std::cerr << "Load failed - " << asset.path << std::endl;
+            return;
         }
-        confFile >> token;
+        auto& entry = _soundEffects[slotFor(_soundIds, _soundEffects, asset.name)];
+        entry.path = asset.path;
+        entry.asset = std::move(sb);
+        setResident(entry, asset.samples.size() * sizeof(sf::Int16));
+        std::cout << "Loaded sound effect: " << asset.path << std::endl;
+        break;
+    }
+
+    case LoadedAsset::Kind::Task:
+        uploadAtlas();
+        break;
     }
-    confFile.close();
 }
 
-void Assets::loadAnimationRecs(const std::string& path)
+// the records go in last, a record into a packed texture needs the atlas built
+void Assets::endLoading()
 {
-    std::ifstream confFile(path);
-    if (confFile.fail()) {
-        std::cerr << "Open file " << path << " failed\n";
-        confFile.close();
-        exit(1);
-    }
+    for (auto& [name, sr] : _pendingSprites)
+        addSpriteRec(name, std::move(sr));
+    for (auto& [name, ar] : _pendingAnimations)
+        addAnimationRec(name, std::move(ar));
 
-    std::string token{ "" };
-    confFile >> token;
-    while (confFile) {
-        if (token == "Animation") {
-            float duration;
-            std::string name;
-            AnimationRec ar;
-            confFile >> name >> ar.texName >> ar.frameSize.x
-                >> ar.frameSize.y >> ar.numbFrames >> duration >> ar.repeat;
-            ar.duration = sf::seconds(duration);
-            addAnimationRec(name, ar);
-        }
-        else {
-            // ignore rest of line and continue
-            std::string buffer;
-            std::getline(confFile, buffer);
+    _pendingSprites.clear();
+    _pendingAnimations.clear();
+    _loader.reset();
+    _loading = false;
+}
+
+bool Assets::pumpLoading(sf::Time budget)
+{
+    if (!_loader)
+        return false;
+
+    const bool done = _loader->finish(budget, [this](LoadedAsset& asset) { finishLoaded(asset); });
+    _loadFinished = _loader->finished();
+    if (done)
+        endLoading();
+    return !done;
+}
+
+void Assets::finishLoading()
+{
+    if (!_loader)
+        return;
+
+    _loader->finishAll([this](LoadedAsset& asset) { finishLoaded(asset); });
+    _loadFinished = _loader->finished();
+    endLoading();
+}
+
+void Assets::cancelLoading()
+{
+    _loader.reset();
+}
+
+bool Assets::isLoading() const
+{
+    return _loading;
+}
+
+float Assets::loadingProgress() const
+{
+    const size_t total = _loadTotal;
+    return total ? static_cast<float>(_loadFinished) / static_cast<float>(total) : 1.f;
+}
+
+void Assets::uploadAtlas()
+{
+    // pages are shared by every packed texture, they stay
+    std::lock_guard<std::mutex> lock(_residencyMutex);
+    std::vector<uint32_t> pages;
+    for (size_t p{ 0 }; p < _atlas->pageCount(); ++p) {
+        const std::string page = TextureAtlas::pageName(p);
+        pages.push_back(slotFor(_textureIds, _textures, page));
+        auto texture = std::make_unique<sf::Texture>();
+        // its textures are unpacked again and load from their own files on first use
+        if (!texture->loadFromImage(_atlas->pageImage(p))) {
+            std::cerr << "Could not load atlas page: " << page << std::endl;
+            for (const auto& [name, path] : _atlas->dropPage(p))
+                _textures[slotFor(_textureIds, _textures, name)].path = path;
+            continue;
         }
-        confFile >> token;
+        texture->setSmooth(true);
+
+        auto& entry = _textures[pages.back()];
+        entry.path = page;
+        entry.pinned = true;
+        entry.asset = std::move(texture);
+        const sf::Vector2u size = _atlas->pageImage(p).getSize();
+        setResident(entry, size_t{ size.x } * size.y * 4);
     }
-    confFile.close();
+
+    // a packed texture's id is its page's
+    for (const auto& [name, entry] : _atlas->entries())
+        _textureIds.bind(name, pages[entry.page]);
 }
 
 void Assets::loadFromFile(const std::string path) {
-    loadFonts(path);
-    loadTextures(path);
-    //loadSounds(path);
-    loadSpriteRecs(path);
-    loadAnimationRecs(path);
+    ConfigParser parser;
+    addConfigDirectives(parser);
+    parser.parseFile(path);
+    finishConfig();
 }
@@ -8,22 +8,149 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 
-#include <map>
+#include "AssetBundle.h"
+#include "AssetLoader.h"
+#include "AssetRef.h"
+#include "ConfigParser.h"
+#include "TextureAtlas.h"
+#include "Utilities.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct CSprite;
+struct CAnimation;
+
+
+// Asset handles
+//  a name is resolved once into a typed id that indexes a flat array, getting an
+//  asset by id neither hashes nor compares a string. An id stays valid for the
+//  life of Assets, a name nothing was added under resolves to an invalid id.
+template<typename Tag>
+struct AssetId {
+    static constexpr uint32_t Invalid{ 0xffffffffu };
+    uint32_t        index{ Invalid };
+
+    constexpr bool  isValid() const { return index != Invalid; }
+    constexpr bool  operator==(const AssetId&) const = default;
+};
+
+using TextureId = AssetId<struct TextureTag>;
+using SoundId = AssetId<struct SoundTag>;
+using FontId = AssetId<struct FontTag>;
+using SpriteId = AssetId<struct SpriteTag>;
+using AnimId = AssetId<struct AnimTag>;
+
+
+// a name with its hashString, "player"_asset is hashed at compile time
+struct AssetName {
+    std::string_view    text;
+    uint64_t            hash;
+
+    constexpr AssetName(std::string_view name) : text(name), hash(hashString(name)) {}
+    constexpr AssetName(const char* name) : AssetName(std::string_view(name)) {}
+    AssetName(const std::string& name) : AssetName(std::string_view(name)) {}
+};
+
+consteval AssetName operator""_asset(const char* name, size_t length)
+{
+    return AssetName(std::string_view(name, length));
+}
+
+
+// name hash -> index into one kind's array. Lookups go by hash and check the
+// name, a second name with the hash of one already bound is refused when it is
+// bound
+class AssetNames {
+private:
+    struct Bound {
+        uint32_t        index;
+        std::string     name;           // to tell colliding names apart
+    };
+    struct KeyHash {
+        size_t operator()(uint64_t hash) const { return static_cast<size_t>(hash); }  // already a hash
+    };
+    std::unordered_map<uint64_t, Bound, KeyHash>    _bound;
+
+public:
+    static constexpr uint32_t Invalid{ TextureId::Invalid };   // the same for every kind
+
+    uint32_t        find(const AssetName& name) const;      // Invalid when not bound
+    void            bind(const AssetName& name, uint32_t index);
+};
+
 
 struct AnimationRec {
     std::string     texName;
+    TextureId       texture;            // texName, resolved when the record is added
     sf::Vector2i    frameSize;
     size_t          numbFrames;
     sf::Time        duration;
     bool            repeat;
+    sf::Vector2i    origin{ 0, 0 };     // top left of the first frame, frames run to the right
 };
 
 struct SpriteRec {
     std::string     texName;
+    TextureId       texture;            // texName, resolved when the record is added
     sf::IntRect     texRect;
 };
 
 
+// an entry with its asset, Assets keeps them in deques so they never move
+template<typename T>
+struct Resident : ResidentEntry {
+    std::unique_ptr<T>  asset;
+
+    bool            isResident() const override { return asset != nullptr; }
+    void            unload() override { asset.reset(); bytes = 0; }
+    void            retain() override;
+    void            release() override;
+};
+
+struct ResidencyStats {
+    size_t          textures{ 0 };
+    size_t          residentTextures{ 0 };
+    size_t          sounds{ 0 };
+    size_t          residentSounds{ 0 };
+    size_t          residentBytes{ 0 };
+    size_t          budgetBytes{ 0 };       // 0 = no budget
+    size_t          referenced{ 0 };        // held by at least one AssetRef
+    size_t          pinned{ 0 };
+    size_t          loads{ 0 };             // since startup, reloads included
+    size_t          evictions{ 0 };
+};
+
+
+// a sound and the buffer it plays, the buffer stays resident while the sound
+// exists. The sf::Sound is held by pointer, moving a SoundEffect keeps it playing
+class SoundEffect {
+private:
+    SoundRef                    _buffer;
+    std::unique_ptr<sf::Sound>  _sound;     // after _buffer, it stops before the buffer is let go
+
+public:
+    SoundEffect() = default;
+    explicit SoundEffect(SoundRef buffer)
+        : _buffer(std::move(buffer)), _sound(std::make_unique<sf::Sound>(*_buffer)) {}
+    SoundEffect(SoundEffect&&) noexcept = default;
+    SoundEffect& operator=(SoundEffect&& other) noexcept {
+        _sound = std::move(other._sound);
+        _buffer = std::move(other._buffer);
+        return *this;
+    }
+
+    sf::Sound&      sound() { return *_sound; }
+    explicit operator bool() const { return _sound != nullptr; }
+};
+
+
 class Assets {
 
 private:
@@ -41,23 +168,105 @@ public:
     Assets& operator=(Assets&&) = delete;
 
 private:
-    std::map<std::string, std::unique_ptr<sf::Font>>            _fontMap;
-    std::map<std::string, std::unique_ptr<sf::SoundBuffer>>     _soundEffects;
-    std::map<std::string, sf::Texture>                          _textures;
-    std::map<std::string, SpriteRec>                            _spriteRecs;
-    std::map<std::string, AnimationRec>                         _animationRecs;
+    // indexed by the ids, deques so AssetRefs and returned references stay put as they grow
+    std::vector<std::unique_ptr<sf::Font>>                      _fonts;
+    std::deque<Resident<sf::SoundBuffer>>                       _soundEffects;
+    std::deque<Resident<sf::Texture>>                           _textures;
+    std::deque<SpriteRec>                                       _spriteRecs;
+    std::deque<AnimationRec>                                    _animationRecs;
+    AssetNames                                                  _fontIds;
+    AssetNames                                                  _soundIds;
+    AssetNames                                                  _textureIds;    // a packed texture is bound to its page
+    AssetNames                                                  _spriteIds;
+    AssetNames                                                  _animIds;
+    bool                                                        _headless{ false };
+
+    // set by an Atlas line, textures are then packed into pages instead of loaded one by one
+    std::unique_ptr<TextureAtlas>                               _atlas;
+
+
+    // read by the config pass, applied by finishConfig
+    struct PendingFile {
+        LoadedAsset::Kind   kind;
+        std::string         name;
+        std::string         path;
+    };
+    std::vector<PendingFile>                                    _pendingFiles;
+    std::vector<std::pair<std::string, SpriteRec>>              _pendingSprites;
+    std::vector<std::pair<std::string, AnimationRec>>           _pendingAnimations;
+
+    // opened by Bundle lines, a file found in one is read from its mapping, the
+    // mappings stay open because fonts keep reading from their memory
+    std::vector<std::unique_ptr<AssetBundle>>                   _bundles;
+
+    // background loading, the counts are read by scenes on the simulation thread
+    std::unique_ptr<AssetLoader>                                _loader;
+    std::atomic<bool>                                           _loading{ false };
+    std::atomic<size_t>                                         _loadTotal{ 0 };
+    std::atomic<size_t>                                         _loadFinished{ 0 };
+
+    // set by a Residency line, the entries are guarded by the mutex because
+    // scenes on the simulation thread load while the main thread collects
+    mutable std::mutex                                          _residencyMutex;
+    size_t                                                      _budgetBytes{ 0 };
+    bool                                                        _lazy{ false };     // textures and sounds load on first use
+    size_t                                                      _residentBytes{ 0 };
+    uint64_t                                                    _frame{ 0 };
+    size_t                                                      _loads{ 0 };
+    size_t                                                      _evictions{ 0 };
+    size_t                                                      _idleBytes{ 0 };    // resident, neither held nor pinned
 
+    // lazy textures decoded off the main thread, collect() uploads them
+    struct PendingUpload {
+        Resident<sf::Texture>*  entry;
+        sf::Image               image;
+    };
+    std::thread::id                                             _mainThread;
+    std::vector<PendingUpload>                                  _uploads;
 
-    void loadFonts(const std::string& path);
-    void loadTextures(const std::string& path);
-    void loadSounds(const std::string& path);
-    void loadSpriteRecs(const std::string& path);
-    void loadAnimationRecs(const std::string& path);
+    template<typename T> friend struct Resident;
+    void retain(ResidentEntry& entry);
+    void release(ResidentEntry& entry);
+    void hold(ResidentEntry& entry);
+    void pin(ResidentEntry& entry);
+    void evict(ResidentEntry& entry);
+    void uploadPending(const Resident<sf::Texture>* only = nullptr);
+    Resident<sf::Texture>& textureEntry(TextureId id);
+    Resident<sf::SoundBuffer>& soundEntry(SoundId id);
+    void makeResident(Resident<sf::Texture>& entry);
+    void makeResident(Resident<sf::SoundBuffer>& entry);
+    void setResident(ResidentEntry& entry, size_t bytes);
+
+
+    std::string_view findInBundles(const std::string& path) const;
+    void addPendingFile(LoadedAsset::Kind kind, const std::string& name, const std::string& path);
+    void registerLazy(const PendingFile& file);
+    void finishLoaded(LoadedAsset& asset);
+    void uploadAtlas();
+    void endLoading();
 
 
 public:
     void loadFromFile(const std::string path);
 
+    // for a parser shared with other readers of the same file, call
+    // finishConfig after it has parsed to load the files and add the records.
+    //  With jobs the files are decoded on the workers and the main thread calls
+    //  pumpLoading every frame until it returns false, without jobs it all
+    //  loads before finishConfig returns
+    void addConfigDirectives(ConfigParser& parser);
+    void finishConfig(JobSystem* jobs = nullptr);
+
+    // main thread, finishes decoded assets for up to budget, true while loading
+    bool pumpLoading(sf::Time budget);
+    void finishLoading();           // blocks until everything is loaded
+    void cancelLoading();           // before the JobSystem goes away
+    bool isLoading() const;
+    float loadingProgress() const;  // 0 to 1, safe from any thread
+
+    // headless, textures are registered empty instead of loaded, there is no GL context
+    void setHeadless(bool headless);
+
     void addFont(const std::string& fontName, const std::string& path);
     void addSound(const std::string& soundEffectName, const std::string& path);
     void addTexture(const std::string& textureName, const std::string& path, bool smooth = true);
@@ -65,14 +274,63 @@ public:
     void addAnimationRec(const std::string& name, AnimationRec ar);
 
 
-    const sf::Font& getFont(const std::string& fontName) const;
-    const sf::SoundBuffer& getSound(const std::string& fontName) const;
-    const sf::Texture& getTexture(const std::string& textureName) const;
-    const SpriteRec& getSpriteRec(const std::string& name) const;
-    const AnimationRec& getAnimationRec(const std::string& name) const;
+    // resolve a name once, at scene init say, and keep the id
+    FontId fontId(AssetName name) const;
+    SoundId soundId(AssetName name) const;
+    TextureId textureId(AssetName name) const;
+    SpriteId spriteId(AssetName name) const;
+    AnimId animId(AssetName name) const;
+
+    // the name overloads resolve on every call
+    const sf::Font& getFont(FontId id) const;
+    const sf::Font& getFont(AssetName fontName) const;
+    // loaded on first use and pinned, acquireSound lets it be evicted when let go
+    const sf::SoundBuffer& getSound(SoundId id);
+    const sf::SoundBuffer& getSound(AssetName soundName);
+    // a packed texture returns its atlas page, getTextureRect gives where it is on the page.
+    // Off the main thread a lazy texture is empty until the next collect(), give
+    // its sprites the rect from getTextureRect rather than the texture's size
+    const sf::Texture& getTexture(TextureId id);
+    const sf::Texture& getTexture(AssetName textureName);
+    sf::IntRect getTextureRect(AssetName textureName);
+    const SpriteRec& getSpriteRec(SpriteId id) const;
+    const SpriteRec& getSpriteRec(AssetName name) const;
+    const AnimationRec& getAnimationRec(AnimId id) const;
+    const AnimationRec& getAnimationRec(AssetName name) const;
+
+    // loaded on first use, resident while a reference is held
+    TextureRef acquireTexture(TextureId id);
+    TextureRef acquireTexture(AssetName textureName);
+    SoundRef acquireSound(SoundId id);
+    SoundRef acquireSound(AssetName soundName);
+
+    // components for an entity, the sprite holds its texture. An animation's
+    // sprite starts on the first frame
+    CSprite makeSprite(SpriteId id);
+    CSprite makeSprite(AnimId id);
+    CAnimation makeAnimation(AnimId id) const;
+
+    // main thread, once a frame after drawing. Uploads the textures loaded off
+    // it, then evicts while over budget, an entry let go in the last few frames
+    // is kept, a snapshot may still draw it
+    void collect();
+    ResidencyStats residency() const;
 
 };
 
 
+template<typename T>
+void Resident<T>::retain()
+{
+    Assets::getInstance().retain(*this);
+}
+
+template<typename T>
+void Resident<T>::release()
+{
+    Assets::getInstance().release(*this);
+}
+
+
 #endif //BREAKOUT_ASSETS_H
 
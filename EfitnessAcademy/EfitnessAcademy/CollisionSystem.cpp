@@ -0,0 +1,185 @@
+#include "CollisionSystem.h"
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+	// bodies per parallel narrow phase job
+	constexpr size_t CollisionGrain{ 1024 };
+}
+
+
+CollisionSystem::CollisionSystem(float cellSize) : _grid(cellSize)
+{}
+
+void CollisionSystem::setCellSize(float cellSize)
+{
+	_grid.setCellSize(cellSize);
+}
+
+float CollisionSystem::getCellSize() const
+{
+	return _grid.getCellSize();
+}
+
+const std::vector<Contact>& CollisionSystem::contacts() const
+{
+	return _contacts;
+}
+
+void CollisionSystem::update(EntityManager& entities)
+{
+	gatherBodies(entities);
+	_grid.build();
+
+	_contacts.clear();
+	findContacts(0, _bodies.size(), _contacts);
+}
+
+void CollisionSystem::update(EntityManager& entities, JobSystem& jobs)
+{
+	gatherBodies(entities);
+	_grid.build();
+
+	const size_t chunks = (_bodies.size() + CollisionGrain - 1) / CollisionGrain;
+	if (_chunkContacts.size() < chunks)
+		_chunkContacts.resize(chunks);
+
+	jobs.parallelFor(_bodies.size(), CollisionGrain, [this](size_t begin, size_t end) {
+		auto& out = _chunkContacts[begin / CollisionGrain];
+		out.clear();
+		findContacts(begin, end, out);
+	});
+
+	_contacts.clear();
+	for (size_t i{ 0 }; i < chunks; ++i)
+		_contacts.insert(_contacts.end(), _chunkContacts[i].begin(), _chunkContacts[i].end());
+}
+
+void CollisionSystem::gatherBodies(EntityManager& entities)
+{
+	_bodies.clear();
+	_grid.clear();
+
+	auto addBody = [this](const Entity& e, sf::Vector2f pos, sf::Vector2f halfSize, float radius) {
+		_bodies.push_back(Body{ e.getHandle(), pos, halfSize, radius });
+		_grid.add(_grid.cellsOf(pos - halfSize, pos + halfSize));
+	};
+
+	entities.view<CTransform, CCollision>().each([&](Entity& e, CTransform& tfm, CCollision& col) {
+		addBody(e, tfm.pos, sf::Vector2f(col.radius, col.radius), col.radius);
+	});
+	entities.view<CTransform, CBoundingBox>(exclude<CCollision>).each([&](Entity& e, CTransform& tfm, CBoundingBox& box) {
+		addBody(e, tfm.pos, box.halfSize, 0.f);
+	});
+}
+
+void CollisionSystem::findContacts(size_t begin, size_t end, std::vector<Contact>& out) const
+{
+	Contact contact;
+	for (size_t i{ begin }; i < end; ++i) {
+		const auto& a = _bodies[i];
+		const auto& cellsA = _grid.cells(static_cast<uint32_t>(i));
+		for (int32_t y{ cellsA.minY }; y <= cellsA.maxY; ++y) {
+			for (int32_t x{ cellsA.minX }; x <= cellsA.maxX; ++x) {
+				_grid.forEachIn(x, y, [&](uint32_t j) {
+					// each pair once, from its lower body, in the first cell both cover
+					if (j <= i || !SpatialGrid::isFirstShared(cellsA, _grid.cells(j), x, y))
+						return;
+					if (testPair(a, _bodies[j], contact))
+						out.push_back(contact);
+				});
+			}
+		}
+	}
+}
+
+bool CollisionSystem::testPair(const Body& a, const Body& b, Contact& contact) const
+{
+	const sf::Vector2f d = b.pos - a.pos;
+
+	// circle - circle
+	if (a.radius > 0.f && b.radius > 0.f) {
+		const float r = a.radius + b.radius;
+		const float dist2 = d.x * d.x + d.y * d.y;
+		if (dist2 >= r * r)
+			return false;
+
+		const float dist = std::sqrt(dist2);
+		contact.normal = (dist > 0.f) ? d / dist : sf::Vector2f(1.f, 0.f);
+		contact.depth = r - dist;
+	}
+
+	// box - box, separate along the axis of least overlap
+	else if (a.radius == 0.f && b.radius == 0.f) {
+		const float ox = a.halfSize.x + b.halfSize.x - std::abs(d.x);
+		const float oy = a.halfSize.y + b.halfSize.y - std::abs(d.y);
+		if (ox <= 0.f || oy <= 0.f)
+			return false;
+
+		if (ox < oy) {
+			contact.normal = sf::Vector2f(d.x < 0.f ? -1.f : 1.f, 0.f);
+			contact.depth = ox;
+		}
+		else {
+			contact.normal = sf::Vector2f(0.f, d.y < 0.f ? -1.f : 1.f);
+			contact.depth = oy;
+		}
+	}
+
+	// circle - box, against the closest point of the box to the circle's centre
+	else {
+		const bool circleFirst = a.radius > 0.f;
+		const Body& circle = circleFirst ? a : b;
+		const Body& box = circleFirst ? b : a;
+
+		const sf::Vector2f rel = circle.pos - box.pos;
+		const sf::Vector2f closest(
+			std::clamp(rel.x, -box.halfSize.x, box.halfSize.x),
+			std::clamp(rel.y, -box.halfSize.y, box.halfSize.y));
+
+		// normal from box to circle until flipped below
+		if (closest == rel) {
+			// centre inside the box, push out through the nearest face
+			const float ox = box.halfSize.x - std::abs(rel.x);
+			const float oy = box.halfSize.y - std::abs(rel.y);
+			if (ox < oy) {
+				contact.normal = sf::Vector2f(rel.x < 0.f ? -1.f : 1.f, 0.f);
+				contact.depth = ox + circle.radius;
+			}
+			else {
+				contact.normal = sf::Vector2f(0.f, rel.y < 0.f ? -1.f : 1.f);
+				contact.depth = oy + circle.radius;
+			}
+		}
+		else {
+			const sf::Vector2f out = rel - closest;
+			const float dist2 = out.x * out.x + out.y * out.y;
+			if (dist2 >= circle.radius * circle.radius)
+				return false;
+
+			const float dist = std::sqrt(dist2);
+			contact.normal = out / dist;
+			contact.depth = circle.radius - dist;
+		}
+
+		if (circleFirst)
+			contact.normal = -contact.normal;
+	}
+
+	contact.a = a.handle;
+	contact.b = b.handle;
+	return true;
+}
+
+void CollisionSystem::query(const sf::FloatRect& area, std::vector<EntityHandle>& out) const
+{
+	const sf::Vector2f min(area.left, area.top);
+	const sf::Vector2f max(area.left + area.width, area.top + area.height);
+	_grid.query(_grid.cellsOf(min, max), [&](uint32_t i) {
+		const auto& b = _bodies[i];
+		if (b.pos.x + b.halfSize.x >= min.x && b.pos.x - b.halfSize.x <= max.x
+			&& b.pos.y + b.halfSize.y >= min.y && b.pos.y - b.halfSize.y <= max.y)
+			out.push_back(b.handle);
+	});
+}
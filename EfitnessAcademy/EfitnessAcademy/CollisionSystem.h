@@ -0,0 +1,62 @@
+#pragma once
+
+#include "EntityManager.h"
+#include "JobSystem.h"
+#include "SpatialGrid.h"
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+
+// one overlapping pair, normal points from a to b
+struct Contact
+{
+	EntityHandle	a;
+	EntityHandle	b;
+	sf::Vector2f	normal{ 0.f, 0.f };
+	float			depth{ 0.f };
+};
+
+
+// Broad and narrow phase collision for CCollision (circle) and CBoundingBox (AABB)
+//  every entity with a CTransform and either shape is put in a SpatialGrid,
+//  rebuilt each update so the cost is linear in the number of bodies. Only
+//  bodies that share a cell are tested. Cells should be about the size of a typical body, a body
+//  much larger than a cell is stored in every cell it covers.
+//  An entity with both components collides as a circle.
+class CollisionSystem
+{
+private:
+	struct Body {
+		EntityHandle	handle;
+		sf::Vector2f	pos;
+		sf::Vector2f	halfSize;		// radius, radius for circles
+		float			radius{ 0.f };	// 0 for boxes
+	};
+
+	SpatialGrid						_grid;			// item i is _bodies[i]
+	std::vector<Body>				_bodies;
+	std::vector<Contact>			_contacts;
+	std::vector<std::vector<Contact>>	_chunkContacts;	// per parallelFor chunk, merged in order
+
+	void			gatherBodies(EntityManager& entities);
+	void			findContacts(size_t begin, size_t end, std::vector<Contact>& out) const;
+	bool			testPair(const Body& a, const Body& b, Contact& contact) const;
+
+public:
+	explicit CollisionSystem(float cellSize = 64.f);
+
+	void			setCellSize(float cellSize);
+	float			getCellSize() const;
+
+	// rebuild the grid from the entities' CTransform::pos and find this frame's contacts
+	//  with a JobSystem the narrow phase is split across its threads, the
+	//  contact list is in the same order either way
+	void			update(EntityManager& entities);
+	void			update(EntityManager& entities, JobSystem& jobs);
+
+	const std::vector<Contact>&	contacts() const;
+
+	// every body whose bounds overlap the rect, as of the last update
+	void			query(const sf::FloatRect& area, std::vector<EntityHandle>& out) const;
+};
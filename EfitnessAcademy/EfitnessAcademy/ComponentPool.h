@@ -0,0 +1,102 @@
+#ifndef BREAKOUT_COMPONENTPOOL_H
+#define BREAKOUT_COMPONENTPOOL_H
+
+
+#include <vector>
+#include <limits>
+#include <cassert>
+#include <utility>
+
+
+// Dense storage for one component type (sparse set)
+//  _components and _owners are packed and kept parallel, so iterating a pool
+//  walks one contiguous array of T. _sparse maps an entity id to its slot
+//  in the dense arrays. Removal is swap-and-pop, so order is not stable.
+template<typename T>
+class ComponentPool {
+public:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+private:
+    std::vector<T>          _components;
+    std::vector<size_t>     _owners;
+    std::vector<size_t>     _sparse;
+
+public:
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    inline bool contains(size_t id) const {
+        return id < _sparse.size() && _sparse[id] != npos;
+    }
+
+
+    template<typename... TArgs>
+    inline T& emplace(size_t id, TArgs &&... mArgs) {
+        if (contains(id)) {
+            auto& component = _components[_sparse[id]];
+            component = T(std::forward<TArgs>(mArgs)...);
+            return component;
+        }
+
+        if (id >= _sparse.size())
+            _sparse.resize(id + 1, npos);
+
+        _sparse[id] = _components.size();
+        _owners.push_back(id);
+        return _components.emplace_back(std::forward<TArgs>(mArgs)...);
+    }
+
+
+    inline bool remove(size_t id) {
+        if (!contains(id))
+            return false;
+
+        // move the last component into the hole and fix up its owner's slot
+        const size_t slot = _sparse[id];
+        const size_t last = _components.size() - 1;
+        if (slot != last) {
+            _components[slot] = std::move(_components[last]);
+            _owners[slot] = _owners[last];
+            _sparse[_owners[slot]] = slot;
+        }
+        _components.pop_back();
+        _owners.pop_back();
+        _sparse[id] = npos;
+        return true;
+    }
+
+
+    inline T& get(size_t id) {
+        assert(contains(id));
+        return _components[_sparse[id]];
+    }
+
+
+    inline const T& get(size_t id) const {
+        assert(contains(id));
+        return _components[_sparse[id]];
+    }
+
+
+    inline void reserve(size_t n) {
+        _components.reserve(n);
+        _owners.reserve(n);
+    }
+
+
+    // owners()[i] is the id of the entity that owns data()[i]
+    inline const std::vector<size_t>& owners() const { return _owners; }
+    inline T* data() { return _components.data(); }
+    inline const T* data() const { return _components.data(); }
+    inline size_t size() const { return _components.size(); }
+    inline bool empty() const { return _components.empty(); }
+
+    inline iterator begin() { return _components.begin(); }
+    inline iterator end() { return _components.end(); }
+    inline const_iterator begin() const { return _components.begin(); }
+    inline const_iterator end() const { return _components.end(); }
+};
+
+
+#endif //BREAKOUT_COMPONENTPOOL_H
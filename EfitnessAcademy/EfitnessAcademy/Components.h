@@ -8,17 +8,23 @@
 
 #include <memory>
 #include <SFML/Graphics.hpp>
+#include "AssetRef.h"
 #include "Utilities.h"
 
 
+// presence is tracked by the owning Entity's signature, not by the component
 struct Component
 {
-    bool		has{ false };
     Component() = default;
 };
 
+// a sprite made from a TextureRef keeps its texture resident while it exists,
+// Assets::makeSprite makes one from a record. The plain texture overloads are
+// for textures from getTexture
 struct CSprite : public Component {
     sf::Sprite sprite;
+    TextureRef texture;
+    int        layer{ 0 };      // drawn in ascending order by SpriteBatch
 
     CSprite() = default;
     CSprite(const sf::Texture& t)
@@ -29,6 +35,10 @@ struct CSprite : public Component {
         : sprite(t, r) {
         centerOrigin(sprite);
     }
+    CSprite(TextureRef t, sf::IntRect r)
+        : sprite(*t, r), texture(std::move(t)) {
+        centerOrigin(sprite);
+    }
 };
 
 
@@ -69,6 +79,7 @@ struct CAnimation : public Component
     sf::Time        timePerFrame{ sf::Time::Zero };
     sf::Time        countDown{ sf::Time::Zero };
     bool            isRepeat{ true };
+    sf::Vector2i    origin{ 0, 0 };     // top left of the first frame, frames run to the right
 
     CAnimation() = default;
 
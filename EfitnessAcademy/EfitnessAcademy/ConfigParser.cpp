@@ -0,0 +1,118 @@
+#include "ConfigParser.h"
+#include "MappedFile.h"
+#include <cstdlib>
+#include <iostream>
+
+
+namespace {
+	bool isSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+	}
+}
+
+
+ConfigError::ConfigError(size_t line, size_t column, const std::string& message)
+	: std::runtime_error(message), _line(line), _column(column)
+{}
+
+size_t ConfigError::line() const
+{
+	return _line;
+}
+
+size_t ConfigError::column() const
+{
+	return _column;
+}
+
+
+ConfigLine::ConfigLine(std::string_view text, size_t line, size_t column)
+	: _text(text), _line(line), _column(column)
+{}
+
+size_t ConfigLine::skipSpace()
+{
+	while (_pos < _text.size() && isSpace(_text[_pos]))
+		++_pos;
+	return _pos;
+}
+
+bool ConfigLine::atEnd()
+{
+	return skipSpace() == _text.size();
+}
+
+std::string_view ConfigLine::next(std::string_view what)
+{
+	_tokenStart = skipSpace();
+	if (_pos == _text.size())
+		throw error("expected " + std::string(what));
+
+	while (_pos < _text.size() && !isSpace(_text[_pos]))
+		++_pos;
+	return _text.substr(_tokenStart, _pos - _tokenStart);
+}
+
+ConfigError ConfigLine::error(const std::string& message) const
+{
+	return ConfigError(_line, _column + _tokenStart, message);
+}
+
+size_t ConfigLine::line() const
+{
+	return _line;
+}
+
+
+void ConfigParser::on(std::string_view directive, Handler handler)
+{
+	_handlers[hashString(directive)] = std::move(handler);
+}
+
+size_t ConfigParser::parse(std::string_view text, std::string_view name)
+{
+	// a UTF-8 byte order mark from an editor is not part of the first directive
+	if (text.starts_with("\xEF\xBB\xBF"))
+		text.remove_prefix(3);
+
+	size_t errors{ 0 };
+	size_t lineNumber{ 0 };
+	while (!text.empty()) {
+		++lineNumber;
+		const size_t newline = text.find('\n');
+		std::string_view line = text.substr(0, newline);
+		text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+
+		const size_t comment = line.find('#');
+		if (comment != std::string_view::npos)
+			line = line.substr(0, comment);
+
+		ConfigLine args(line, lineNumber, 1);
+		if (args.atEnd())
+			continue;
+
+		auto handler = _handlers.find(hashString(args.next("directive")));
+		if (handler == _handlers.end())
+			continue;
+
+		try {
+			handler->second(args);
+		}
+		catch (const ConfigError& e) {
+			std::cerr << name << ":" << e.line() << ":" << e.column() << ": " << e.what() << "\n";
+			++errors;
+		}
+	}
+	return errors;
+}
+
+size_t ConfigParser::parseFile(const std::string& path)
+{
+	MappedFile file;
+	if (!file.open(path)) {
+		std::cerr << "Open file " << path << " failed\n";
+		exit(1);
+	}
+	return parse(file.view(), path);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Utilities.h"
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+
+// a malformed line, where reports 1 based line and column
+class ConfigError : public std::runtime_error
+{
+private:
+	size_t			_line;
+	size_t			_column;
+
+public:
+	ConfigError(size_t line, size_t column, const std::string& message);
+
+	size_t			line() const;
+	size_t			column() const;
+};
+
+
+// the arguments of one directive, tokens are views into the parsed text
+class ConfigLine
+{
+private:
+	std::string_view	_text;			// the line, comment stripped
+	size_t				_pos{ 0 };
+	size_t				_tokenStart{ 0 };
+	size_t				_line;
+	size_t				_column;		// of the first character of _text
+
+	size_t			skipSpace();
+
+public:
+	ConfigLine(std::string_view text, size_t line, size_t column);
+
+	bool			atEnd();
+
+	// the next token, throws a ConfigError naming what when there is none
+	std::string_view	next(std::string_view what);
+
+	// the next token as a number, 0 or 1 for bool, or a copied string
+	template<typename T>
+	T				read(std::string_view what);
+
+	// an error at the token read last
+	ConfigError		error(const std::string& message) const;
+
+	size_t			line() const;
+};
+
+
+// Single pass config reader
+//  the file is memory mapped and walked once, line by line. The first token of
+//  a line names a directive and picks its handler from a table keyed by the
+//  name's hash, the handler reads its arguments from the ConfigLine. Lines
+//  with no handler and everything after a # are skipped. Tokens are views into
+//  the mapping, nothing is allocated until a handler copies a string.
+//  A ConfigError from a handler is reported with its line and column and the
+//  rest of the file is still read, parse returns how many lines failed.
+class ConfigParser
+{
+public:
+	using Handler = std::function<void(ConfigLine&)>;
+
+private:
+	std::unordered_map<std::uint64_t, Handler>	_handlers;
+
+public:
+	// a second handler for a directive replaces the first
+	void			on(std::string_view directive, Handler handler);
+
+	// errors go to std::cerr prefixed with name:line:column
+	size_t			parse(std::string_view text, std::string_view name = "config");
+
+	// exits if the file can not be opened, like the loaders it replaces
+	size_t			parseFile(const std::string& path);
+};
+
+
+template<typename T>
+T ConfigLine::read(std::string_view what)
+{
+	const std::string_view token = next(what);
+	if constexpr (std::is_same_v<T, std::string>) {
+		return std::string(token);
+	}
+	else {
+		static_assert(std::is_arithmetic_v<T>, "ConfigLine::read needs a number, bool or std::string");
+		using Number = std::conditional_t<std::is_same_v<T, bool>, int, T>;
+		Number value{};
+		const auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+		if (ec != std::errc() || end != token.data() + token.size())
+			throw error("bad " + std::string(what) + " '" + std::string(token) + "'");
+		if constexpr (std::is_same_v<T, bool>)
+			return value != 0;
+		else
+			return value;
+	}
+}
@@ -0,0 +1,106 @@
+#include "CullingSystem.h"
+#include <algorithm>
+#include <cmath>
+
+
+CullingSystem::CullingSystem(float cellSize) : _grid(cellSize)
+{}
+
+void CullingSystem::setCellSize(float cellSize)
+{
+	_grid.setCellSize(cellSize);
+}
+
+float CullingSystem::getCellSize() const
+{
+	return _grid.getCellSize();
+}
+
+size_t CullingSystem::drawnCount() const
+{
+	return _drawn;
+}
+
+size_t CullingSystem::culledCount() const
+{
+	return _culled;
+}
+
+sf::FloatRect CullingSystem::viewRect(const sf::View& view)
+{
+	const sf::Vector2f center = view.getCenter();
+	const sf::Vector2f size = view.getSize();
+	sf::Vector2f half(std::abs(size.x) / 2.f, std::abs(size.y) / 2.f);
+
+	if (view.getRotation() != 0.f) {
+		const float radians = view.getRotation() * 3.14159265f / 180.f;
+		const float c = std::abs(std::cos(radians));
+		const float s = std::abs(std::sin(radians));
+		half = sf::Vector2f(half.x * c + half.y * s, half.x * s + half.y * c);
+	}
+	return sf::FloatRect(center - half, half * 2.f);
+}
+
+void CullingSystem::update(EntityManager& entities)
+{
+	_items.clear();
+	_grid.clear();
+
+	auto addItem = [this](const Entity& e, const sf::FloatRect& r) {
+		_items.push_back(Item{ e.getHandle(), r });
+		_grid.add(_grid.cellsOf({ r.left, r.top }, { r.left + r.width, r.top + r.height }));
+	};
+
+	entities.view<CTransform, CSprite>().each([&](Entity& e, CTransform& tfm, CSprite& sprite) {
+		if (e.hasComponent<CBoundingBox>()) {
+			const auto& box = e.getComponent<CBoundingBox>();
+			addItem(e, sf::FloatRect(tfm.pos - box.halfSize, box.size));
+			return;
+		}
+
+		// the same transform SpriteBatch draws it with
+		sf::Transform transform;
+		transform.translate(tfm.pos)
+			.rotate(tfm.angle)
+			.scale(sprite.sprite.getScale())
+			.translate(-sprite.sprite.getOrigin());
+		addItem(e, transform.transformRect(sprite.sprite.getLocalBounds()));
+	});
+
+	_grid.build();
+}
+
+void CullingSystem::query(const sf::View& view, std::vector<EntityHandle>& out)
+{
+	const sf::FloatRect area = viewRect(view);
+	auto overlaps = [&area](const sf::FloatRect& r) {
+		return r.left <= area.left + area.width && r.left + r.width >= area.left
+			&& r.top <= area.top + area.height && r.top + r.height >= area.top;
+	};
+
+	const SpatialGrid::Cells under = _grid.cellsOf({ area.left, area.top }, { area.left + area.width, area.top + area.height });
+	const size_t cells = static_cast<size_t>(under.maxX - under.minX + 1) * static_cast<size_t>(under.maxY - under.minY + 1);
+
+	_visible.clear();
+	if (cells >= _items.size()) {
+		// zoomed out past the grid, walking the items is cheaper than the cells
+		for (uint32_t i{ 0 }; i < _items.size(); ++i)
+			if (overlaps(_items[i].bounds))
+				_visible.push_back(i);
+	}
+	else {
+		_grid.query(under, [&](uint32_t i) {
+			if (overlaps(_items[i].bounds))
+				_visible.push_back(i);
+		});
+
+		// pool order, so sprites of one texture keep their draw order
+		std::sort(_visible.begin(), _visible.end());
+	}
+
+	for (const uint32_t i : _visible)
+		out.push_back(_items[i].handle);
+
+	_drawn = _visible.size();
+	_culled = _items.size() - _visible.size();
+}
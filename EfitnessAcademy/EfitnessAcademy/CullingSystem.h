@@ -0,0 +1,48 @@
+#pragma once
+
+#include "EntityManager.h"
+#include "SpatialGrid.h"
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+
+// View culling for CSprite entities
+//  every entity with a CTransform and a CSprite is put in a SpatialGrid by its
+//  world bounds, its CBoundingBox if it has one, otherwise its sprite's rect at
+//  the CTransform. The grid is rebuilt by update(), query() then only visits
+//  the cells under the view, so what drawing costs grows with
+//  what is on screen rather than with the size of the level.
+//  Cells should be a fraction of the view, levels are much larger than one.
+class CullingSystem
+{
+private:
+	struct Item {
+		EntityHandle	handle;
+		sf::FloatRect	bounds;
+	};
+
+	SpatialGrid						_grid;			// item i is _items[i]
+	std::vector<Item>				_items;
+	std::vector<uint32_t>			_visible;		// item indices, scratch for query
+	size_t							_drawn{ 0 };
+	size_t							_culled{ 0 };
+
+public:
+	explicit CullingSystem(float cellSize = 256.f);
+
+	void			setCellSize(float cellSize);
+	float			getCellSize() const;
+
+	// rebuild the grid from every CTransform and CSprite
+	void			update(EntityManager& entities);
+
+	// the entities whose bounds overlap the view as of the last update, in pool order
+	void			query(const sf::View& view, std::vector<EntityHandle>& out);
+
+	// world rect the view shows, the bounding box when it is rotated
+	static sf::FloatRect	viewRect(const sf::View& view);
+
+	size_t			drawnCount() const;		// of the last query
+	size_t			culledCount() const;
+};
@@ -3,25 +3,39 @@
 //
 
 #include "Entity.h"
+#include "EntityManager.h"
 
-Entity::Entity(size_t id, const std::string& tag)
-    : _tag(tag), _id(id) {
-
-}
-
+// systems running in parallel may destroy the same entity, the check is under the lock too
 void Entity::destroy() {
+    std::lock_guard<std::mutex> lock(_manager->_commandMutex);
+    if (!_active)
+        return;
+
     _active = false;
+    _manager->_EntitiesToDestroy.push_back(getHandle());
 }
 
 const size_t& Entity::getId() const {
     return _id;
 }
 
+EntityHandle Entity::getHandle() const {
+    return EntityHandle{ static_cast<uint32_t>(_id), _generation };
+}
+
 const std::string& Entity::getTag() const {
+    return _manager->getTagName(_tag);
+}
+
+TagId Entity::getTagId() const {
     return _tag;
 }
 
 bool Entity::isActive() const {
-    return _active;
+    return _active.load(std::memory_order_relaxed);
+}
+
+Signature Entity::getSignature() const {
+    return _signature;
 }
 
@@ -6,66 +6,110 @@
 #define BREAKOUT_ENTITY_H
 
 
+#include <atomic>
 #include <tuple>
 #include <string>
+#include <cstdint>
+#include <limits>
 
 #include "Components.h"
 // forward declarations
 class EntityManager;
 
+// Generational handle to an entity
+//  index is the entity's slot in the EntityManager, generation is bumped every
+//  time the slot is recycled so a handle to a dead entity can be detected
+struct EntityHandle {
+    static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+    uint32_t    index{ invalidIndex };
+    uint32_t    generation{ 0 };
+
+    inline bool isNull() const { return index == invalidIndex; }
+    inline bool operator==(const EntityHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    inline bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+};
+
+
+// interned tag, index into the EntityManager's tag table
+using TagId = uint32_t;
+
+
+// every component type the EntityManager keeps a pool for
 using ComponentTuple = std::tuple<CAnimation, CSprite, CState, CTransform, CBoundingBox, CInput, CScore, CCollision, CPlayerState>;
 
+
+// Component signatures
+//  one bit per component type, bit n is set when the entity has the n-th type in ComponentTuple
+using Signature = uint32_t;
+static_assert(std::tuple_size_v<ComponentTuple> <= sizeof(Signature) * 8, "too many components for Signature");
+
+template<typename T, typename Tuple>
+struct TupleIndex;
+
+template<typename T, typename... Ts>
+struct TupleIndex<T, std::tuple<T, Ts...>> {
+    static constexpr size_t value = 0;
+};
+
+template<typename T, typename U, typename... Ts>
+struct TupleIndex<T, std::tuple<U, Ts...>> {
+    static constexpr size_t value = 1 + TupleIndex<T, std::tuple<Ts...>>::value;
+};
+
+template<typename T>
+inline constexpr size_t componentIndex = TupleIndex<T, ComponentTuple>::value;
+
+template<typename... Ts>
+inline constexpr Signature signatureOf = (Signature{ 0 } | ... | (Signature{ 1 } << componentIndex<Ts>));
+
 class Entity {
 private:
     friend class EntityManager;
-    Entity(size_t id, const std::string& tag);      // private ctor, entities can only be created by EntityManager
-
-    const size_t            _id{ 0 };
-    const std::string       _tag{ "Default" };
-    bool                    _active{ true };
-    ComponentTuple          _components;
+    Entity() = default;                             // private ctor, entities can only be created by EntityManager
+
+    // set by EntityManager each time the slot is handed out
+    size_t                  _id{ 0 };
+    uint32_t                _generation{ 0 };
+    TagId                   _tag{ 0 };
+    std::atomic<bool>       _active{ true };        // cleared by destroy, which parallel systems may call
+    bool                    _pending{ true };       // created, not yet added by EntityManager::update
+    Signature               _signature{ 0 };
+    uint32_t                _entitiesPos{ 0 };      // position in EntityManager::_entities
+    uint32_t                _bucketPos{ 0 };        // position in its tag bucket
+    EntityManager*          _manager{ nullptr };
 
 public:
 
     void                    destroy();
     const size_t& getId() const;
+    EntityHandle            getHandle() const;
     const std::string& getTag() const;
+    TagId                   getTagId() const;
     bool                    isActive() const;
+    Signature               getSignature() const;
 
 
 
     // Component API
+    //  components live in the EntityManager's per-type pools, these are a thin
+    //  facade over them. They are defined at the end of EntityManager.h
     template<typename T>
-    inline bool hasComponent() const {
-        return getComponent<T>().has;
-    }
-
+    bool hasComponent() const;
 
     template<typename T, typename... TArgs>
-    inline T& addComponent(TArgs &&... mArgs) {
-        auto& component = getComponent<T>();
-        component = T(std::forward<TArgs>(mArgs)...);
-        component.has = true;
-        return component;
-    }
-
+    T& addComponent(TArgs &&... mArgs);
 
     template<typename T>
-    inline bool removeComponent() {
-        return getComponent<T>().has = false;
-    }
-
+    bool removeComponent();
 
     template<typename T>
-    inline T& getComponent() {
-        return std::get<T>(_components);
-    }
-
+    T& getComponent();
 
     template<typename T>
-    inline const T& getComponent() const {
-        return std::get<T>(_components);
-    }
+    const T& getComponent() const;
 };
 
 
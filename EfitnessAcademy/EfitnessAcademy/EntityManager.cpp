@@ -4,38 +4,145 @@
 
 #include "EntityManager.h"
 #include "Entity.h"
+#include <algorithm>
+#include <stdexcept>
 
 EntityManager::EntityManager() : _totalEntities(0) {}
 
 
-std::shared_ptr<Entity> EntityManager::addEntity(const std::string& tag) {
-    // create a new Entity object
-    auto e = std::shared_ptr<Entity>(new Entity(_totalEntities++, tag));
+Entity* EntityManager::addEntity(std::string_view tag) {
+    return addEntity(internTag(tag));
+}
+
+
+Entity* EntityManager::addEntity(TagId tag) {
+    return &slot(acquireSlot(tag));
+}
+
+
+std::span<const EntityHandle> EntityManager::addEntities(std::string_view tag, size_t n) {
+    return addEntities(internTag(tag), n);
+}
+
+
+std::span<const EntityHandle> EntityManager::addEntities(TagId tag, size_t n) {
+    const size_t first = _EntitiesToAdd.size();
+    _EntitiesToAdd.reserve(first + n);
+    if (n > _freeSlots.size())
+        growSlabs(_generations.size() + n - _freeSlots.size());
 
-    // store it in entities vector
-    _EntitiesToAdd.push_back(e);
-    // return shared pointer to it
-    return e;
+    for (size_t i{ 0 }; i < n; ++i)
+        acquireSlot(tag);
+    return std::span<const EntityHandle>(_EntitiesToAdd.data() + first, n);
 }
 
 
-EntityVec& EntityManager::getEntities(const std::string& tag) {
-    return _entityMap[tag];
+void EntityManager::reserve(size_t n) {
+    growSlabs(n);
+    _freeSlots.reserve(n);
+    _entities.reserve(n);
+    _EntitiesToAdd.reserve(n);
+    std::apply([n](auto&... pool) { (pool.reserve(n), ...); }, _pools);
+}
+
+
+uint32_t EntityManager::acquireSlot(TagId tag) {
+    // reuse a free slot if there is one, the slot keeps its generation
+    uint32_t index;
+    if (!_freeSlots.empty()) {
+        index = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+    else {
+        index = static_cast<uint32_t>(_generations.size());
+        growSlabs(index + 1);
+        _generations.push_back(0);
+    }
+
+    auto& e = slot(index);
+    e._id = index;
+    e._generation = _generations[index];
+    e._tag = tag;
+    e._active = true;
+    e._pending = true;
+    e._signature = 0;
+    e._manager = this;
+    _totalEntities++;
+
+    // store its handle in entities vector
+    _EntitiesToAdd.push_back(e.getHandle());
+    return index;
+}
+
+
+void EntityManager::growSlabs(size_t capacity) {
+    while (_slabs.size() * SlabSize < capacity)
+        _slabs.emplace_back(new Entity[SlabSize]);
+}
+
+
+TagId EntityManager::internTag(std::string_view tag) {
+    const uint64_t hash = hashString(tag);
+    auto found = _tagIds.find(hash);
+    if (found != _tagIds.end()) {
+        if (_tagNames[found->second] != tag)
+            throw std::runtime_error("Tag hash collision - " + std::string(tag));
+        return found->second;
+    }
+
+    const TagId id = static_cast<TagId>(_tagNames.size());
+    _tagIds.emplace(hash, id);
+    _tagNames.emplace_back(tag);
+    _buckets.emplace_back();
+    _stableBuckets.push_back(false);
+    return id;
+}
+
+
+bool EntityManager::findTag(TagHash tag, TagId& id) const {
+    auto found = _tagIds.find(tag.value);
+    if (found == _tagIds.end())
+        return false;
+    id = found->second;
+    return true;
+}
+
+
+const std::string& EntityManager::getTagName(TagId tag) const {
+    return _tagNames.at(tag);
+}
+
+
+void EntityManager::setStableOrder(std::string_view tag, bool stable) {
+    _stableBuckets[internTag(tag)] = stable;
 }
 
 
 void EntityManager::update() {
-    // Remove dead entities
-    removeDeadEntities(_entities);
-    for (auto& [_, entityVec] : _entityMap)
-        removeDeadEntities(entityVec);
+    // nothing changed this frame
+    if (!_hasComponentCommands && _EntitiesToDestroy.empty() && _EntitiesToAdd.empty())
+        return;
 
+    if (_hasComponentCommands)
+        applyComponentCommands();
 
-    // add new entities
-    for (auto e : _EntitiesToAdd)
+    // Remove dead entities
+    destroyEntities();
+
+    // add new entities, skipping any destroyed before they were added
+    for (const auto& h : _EntitiesToAdd)
     {
-        _entities.push_back(e);
-        _entityMap[e->getTag()].push_back(e);
+        if (!isValid(h))
+            continue;
+
+        auto& e = slot(h.index);
+        auto& bucket = _buckets[e.getTagId()];
+        e._pending = false;
+        e._entitiesPos = static_cast<uint32_t>(_entities.size());
+        e._bucketPos = static_cast<uint32_t>(bucket.size());
+        _entities.push_back(h);
+        bucket.push_back(h);
+        refreshViews(e);
     }
     _EntitiesToAdd.clear();
 }
@@ -46,6 +153,124 @@ EntityVec& EntityManager::getEntities() {
 }
 
 
-void EntityManager::removeDeadEntities(EntityVec& v) {
-    v.erase(std::remove_if(v.begin(), v.end(), [](auto e) {return!(e->isActive()); }), v.end());
-}
\ No newline at end of file
+void EntityManager::applyComponentCommands() {
+    for (const auto& [h, mask] : _componentsToRemove) {
+        if (!isValid(h))
+            continue;
+
+        auto& e = slot(h.index);
+        if ((e._signature & mask) == 0)
+            continue;
+        removeComponents(h.index, mask);
+        e._signature &= ~mask;
+        refreshViews(e);
+    }
+    _componentsToRemove.clear();
+
+    std::apply([this](auto&... pending) { (addPendingComponents(pending), ...); }, _componentsToAdd);
+    _hasComponentCommands = false;
+}
+
+
+void EntityManager::destroyEntities() {
+    for (const auto& h : _EntitiesToDestroy) {
+        if (!isValid(h))
+            continue;
+
+        // destroyed before it was added, update() skips its handle
+        auto& e = slot(h.index);
+        if (e._pending) {
+            releaseSlot(h.index);
+            continue;
+        }
+
+        // swap-and-pop out of _entities
+        const EntityHandle last = _entities.back();
+        _entities[e._entitiesPos] = last;
+        slot(last.index)._entitiesPos = e._entitiesPos;
+        _entities.pop_back();
+
+        // and out of its bucket, stable buckets are compacted once below
+        const TagId tag = e.getTagId();
+        auto& bucket = _buckets[tag];
+        if (_stableBuckets[tag]) {
+            if (std::find(_dirtyBuckets.begin(), _dirtyBuckets.end(), tag) == _dirtyBuckets.end())
+                _dirtyBuckets.push_back(tag);
+        }
+        else {
+            const EntityHandle lastInBucket = bucket.back();
+            bucket[e._bucketPos] = lastInBucket;
+            slot(lastInBucket.index)._bucketPos = e._bucketPos;
+            bucket.pop_back();
+        }
+
+        releaseSlot(h.index);
+    }
+    _EntitiesToDestroy.clear();
+
+    // released handles are stale now
+    for (const TagId tag : _dirtyBuckets) {
+        auto& bucket = _buckets[tag];
+        bucket.erase(std::remove_if(bucket.begin(), bucket.end(),
+            [this](const EntityHandle& h) { return !isValid(h); }), bucket.end());
+        for (size_t i{ 0 }; i < bucket.size(); ++i)
+            slot(bucket[i].index)._bucketPos = static_cast<uint32_t>(i);
+    }
+    _dirtyBuckets.clear();
+}
+
+
+void EntityManager::releaseSlot(uint32_t index) {
+    removeFromViews(slot(index));
+    removeComponents(index, slot(index)._signature);
+    _generations[index]++;
+    _freeSlots.push_back(index);
+}
+
+
+void EntityManager::removeComponents(size_t id, Signature mask) {
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        ((mask & (Signature{ 1 } << I) ? (void)std::get<I>(_pools).remove(id) : (void)0), ...);
+    }(std::make_index_sequence<std::tuple_size_v<ComponentPools>>{});
+}
+
+
+ViewCache* EntityManager::getViewCache(Signature include, Signature exclude) {
+    for (auto& v : _views)
+        if (v->include == include && v->exclude == exclude)
+            return v.get();
+
+    // first use of this view, fill it from the live entities
+    auto& v = _views.emplace_back(std::make_unique<ViewCache>());
+    v->include = include;
+    v->exclude = exclude;
+    for (const auto& h : _entities)
+        if (v->matches(slot(h.index).getSignature()))
+            v->insert(h);
+    return v.get();
+}
+
+
+void EntityManager::refreshViews(const Entity& e) {
+    // entities waiting to be added join their views in update()
+    if (e._pending)
+        return;
+
+    const auto index = static_cast<uint32_t>(e.getId());
+    for (auto& v : _views) {
+        const bool inView = v->contains(index);
+        const bool matches = v->matches(e.getSignature());
+        if (matches && !inView)
+            v->insert(e.getHandle());
+        else if (!matches && inView)
+            v->erase(index);
+    }
+}
+
+
+void EntityManager::removeFromViews(const Entity& e) {
+    const auto index = static_cast<uint32_t>(e.getId());
+    for (auto& v : _views)
+        if (v->contains(index))
+            v->erase(index);
+}
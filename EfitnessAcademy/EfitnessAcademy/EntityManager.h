@@ -6,39 +6,342 @@
 #define BREAKOUT_ENTITYMANAGER_H
 
 
-#include <map>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <memory>
+#include <mutex>
+#include <tuple>
+#include <span>
 
-//forward declare
-class Entity;
+#include "Entity.h"
+#include "ComponentPool.h"
+#include "Utilities.h"
 
-using sPtrEntt = std::shared_ptr<Entity>;
-using EntityVec = std::vector<std::shared_ptr<Entity>>;
-using EntityMap = std::map <std::string, EntityVec>;
+using EntityVec = std::vector<EntityHandle>;
+
+
+// hash of a tag name, used to find its TagId without touching strings
+//  "player"_tag is hashed at compile time
+struct TagHash {
+    uint64_t value{ 0 };
+};
+
+consteval TagHash operator""_tag(const char* s, size_t n) {
+    return TagHash{ hashString(std::string_view(s, n)) };
+}
+
+
+// std::tuple<W<T>...> for every T in ComponentTuple
+template<template<typename> typename W, typename Tuple>
+struct WrapTuple;
+
+template<template<typename> typename W, typename... Ts>
+struct WrapTuple<W, std::tuple<Ts...>> {
+    using type = std::tuple<W<Ts>...>;
+};
+
+// components waiting for EntityManager::update() to be added
+template<typename T>
+using PendingComponents = std::vector<std::pair<EntityHandle, T>>;
+
+using ComponentPools = WrapTuple<ComponentPool, ComponentTuple>::type;
+using ComponentCommands = WrapTuple<PendingComponents, ComponentTuple>::type;
+
+
+// Views
+//  a view caches the handles of every live entity whose signature has all of
+//  the include bits and none of the exclude bits. The cache is kept up to date
+//  as components are added and removed, so iterating it costs nothing for
+//  entities that do not match.
+template<typename... Ts>
+struct Exclude {};
+
+template<typename... Ts>
+inline constexpr Exclude<Ts...> exclude{};
+
+struct ViewCache {
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    Signature               include{ 0 };
+    Signature               exclude{ 0 };
+    EntityVec               entities;
+    std::vector<uint32_t>   positions;      // slot index -> position in entities, or npos
+
+    inline bool matches(Signature s) const {
+        return (s & include) == include && (s & exclude) == 0;
+    }
+
+    inline bool contains(uint32_t index) const {
+        return index < positions.size() && positions[index] != npos;
+    }
+
+    inline void insert(EntityHandle h) {
+        if (h.index >= positions.size())
+            positions.resize(h.index + 1, npos);
+        positions[h.index] = static_cast<uint32_t>(entities.size());
+        entities.push_back(h);
+    }
+
+    // swap-and-pop
+    inline void erase(uint32_t index) {
+        const uint32_t pos = positions[index];
+        const EntityHandle last = entities.back();
+        entities[pos] = last;
+        positions[last.index] = pos;
+        entities.pop_back();
+        positions[index] = npos;
+    }
+};
+
+template<typename... Ts>
+class View {
+private:
+    EntityManager* _manager;
+    ViewCache* _cache;
+
+public:
+    View(EntityManager* manager, ViewCache* cache) : _manager(manager), _cache(cache) {}
+
+    inline const EntityVec& handles() const { return _cache->entities; }
+    inline size_t size() const { return _cache->entities.size(); }
+    inline bool empty() const { return _cache->entities.empty(); }
+    inline EntityVec::const_iterator begin() const { return _cache->entities.begin(); }
+    inline EntityVec::const_iterator end() const { return _cache->entities.end(); }
+
+    // fn(Entity&, Ts&...) for every matching entity
+    //  do not add or remove components of the viewed types inside fn
+    template<typename Fn>
+    void each(Fn&& fn);
+};
 
 
 class EntityManager
 {
 private:
     EntityVec	    _entities;
-    EntityMap	    _entityMap;
     size_t		    _totalEntities{ 0 };
     EntityVec	    _EntitiesToAdd;
+    ComponentPools  _pools;
+
+    // Entity slab
+    //  entities live in fixed size pages that are never freed, so an Entity&
+    //  stays valid while more are added. Dead slots go on a free list and are
+    //  handed out again with their generation bumped. Indexed by EntityHandle::index
+    static constexpr size_t                 SlabSize{ 1024 };
+    std::vector<std::unique_ptr<Entity[]>>  _slabs;
+    std::vector<uint32_t>                   _generations;
+    std::vector<uint32_t>                   _freeSlots;
+
+    // interned tags, _tagNames and _buckets are indexed by TagId
+    std::unordered_map<uint64_t, TagId>     _tagIds;
+    std::vector<std::string>                _tagNames;
+    std::vector<EntityVec>                  _buckets;
+    const EntityVec                         _noEntities;
+
+    std::vector<std::unique_ptr<ViewCache>> _views;
+
+    // Command buffer
+    //  structural changes recorded during the frame and applied by update().
+    //  Entities to create are in _EntitiesToAdd. Systems the scheduler runs side
+    //  by side on the workers record destroys and component changes at the same
+    //  time, those go through _commandMutex
+    std::mutex                                          _commandMutex;
+    EntityVec                                           _EntitiesToDestroy;
+    std::vector<std::pair<EntityHandle, Signature>>     _componentsToRemove;
+    ComponentCommands                                   _componentsToAdd;
+    bool                                                _hasComponentCommands{ false };
+    std::vector<bool>                                   _stableBuckets;     // by TagId
+    std::vector<TagId>                                  _dirtyBuckets;
+
+    void            destroyEntities();
+    void            applyComponentCommands();
+
+    template<typename T>
+    inline void addPendingComponents(PendingComponents<T>& pending) {
+        for (auto& [h, component] : pending)
+            if (isValid(h))
+                slot(h.index).template addComponent<T>(std::move(component));
+        pending.clear();
+    }
+    void            removeComponents(size_t id, Signature mask);
+    uint32_t        acquireSlot(TagId tag);
+    void            releaseSlot(uint32_t index);
+    void            growSlabs(size_t capacity);
+
+    inline Entity& slot(uint32_t index) const {
+        return _slabs[index / SlabSize][index % SlabSize];
+    }
 
-    void		    removeDeadEntities(EntityVec& v);
+    ViewCache*      getViewCache(Signature include, Signature exclude);
+    void            refreshViews(const Entity& e);
+    void            removeFromViews(const Entity& e);
+
+    template<typename... Ts>
+    friend class View;
+    friend class Entity;
 
 public:
     EntityManager();
 
-    std::shared_ptr<Entity>         addEntity(const std::string& tag);
+    Entity*                         addEntity(std::string_view tag);
+    Entity*                         addEntity(TagId tag);
+
+    // create n entities at once, the span is valid until the next add or update()
+    std::span<const EntityHandle>   addEntities(std::string_view tag, size_t n);
+    std::span<const EntityHandle>   addEntities(TagId tag, size_t n);
+
+    // make room for n live entities with every component, so spawning up to
+    // that many does not allocate
+    void                            reserve(size_t n);
+
+    // order is not preserved when entities are removed
     EntityVec& getEntities();
-    EntityVec& getEntities(const std::string& tag);
 
+    // tags that were never used return an empty vector, nothing is inserted
+    //  buckets are unordered unless setStableOrder() was called for the tag
+    inline const EntityVec& getEntities(TagId tag) const {
+        return tag < _buckets.size() ? _buckets[tag] : _noEntities;
+    }
+
+    inline const EntityVec& getEntities(TagHash tag) const {
+        auto found = _tagIds.find(tag.value);
+        return found == _tagIds.end() ? _noEntities : _buckets[found->second];
+    }
+
+    inline const EntityVec& getEntities(std::string_view tag) const {
+        return getEntities(TagHash{ hashString(tag) });
+    }
+
+    // Tags
+    //  interning a name allocates the first time only, look-ups never do
+    TagId                           internTag(std::string_view tag);
+    bool                            findTag(TagHash tag, TagId& id) const;
+    const std::string&              getTagName(TagId tag) const;
+
+    // keep the tag's bucket in creation order, removal from it becomes O(n)
+    void                            setStableOrder(std::string_view tag, bool stable = true);
+
+    // nullptr if the handle is stale (its entity was removed)
+    inline Entity* get(EntityHandle h) const {
+        if (!isValid(h))
+            return nullptr;
+        return &slot(h.index);
+    }
+
+    inline bool isValid(EntityHandle h) const {
+        return h.index < _generations.size() && _generations[h.index] == h.generation;
+    }
+
+    // apply the frame's structural changes
+    //  component removes, component adds, destroys, then new entities.
+    //  Commands for entities that are gone by then are dropped
     void                            update();
+
+    // Deferred component changes
+    //  safe to call while iterating a view or a pool, and from systems running
+    //  in parallel. Entity::destroy is deferred the same way
+    template<typename T, typename... TArgs>
+    inline void deferAddComponent(EntityHandle h, TArgs &&... mArgs) {
+        T component(std::forward<TArgs>(mArgs)...);
+        std::lock_guard<std::mutex> lock(_commandMutex);
+        std::get<PendingComponents<T>>(_componentsToAdd).emplace_back(h, std::move(component));
+        _hasComponentCommands = true;
+    }
+
+    template<typename T>
+    inline void deferRemoveComponent(EntityHandle h) {
+        std::lock_guard<std::mutex> lock(_commandMutex);
+        _componentsToRemove.emplace_back(h, signatureOf<T>);
+        _hasComponentCommands = true;
+    }
+
+
+    // Component storage
+    //  each component type is packed in its own pool, systems that only need
+    //  one component should iterate the pool directly instead of the entities
+    template<typename T>
+    inline ComponentPool<T>& getPool() {
+        return std::get<ComponentPool<T>>(_pools);
+    }
+
+    template<typename T>
+    inline const ComponentPool<T>& getPool() const {
+        return std::get<ComponentPool<T>>(_pools);
+    }
+
+
+    // entities that have all of Ts and none of the excluded types
+    //  view<CTransform, CSprite>(exclude<CPlayerState>)
+    template<typename... Ts, typename... Xs>
+    inline View<Ts...> view(Exclude<Xs...> = {}) {
+        return View<Ts...>(this, getViewCache(signatureOf<Ts...>, signatureOf<Xs...>));
+    }
+
+
+    // fn(size_t id, T& component) for every entity that has a T
+    template<typename T, typename Fn>
+    inline void forEach(Fn&& fn) {
+        auto& pool = getPool<T>();
+        const auto& owners = pool.owners();
+        T* components = pool.data();
+        for (size_t i{ 0 }; i < pool.size(); ++i)
+            fn(owners[i], components[i]);
+    }
 };
 
 
-#endif //BREAKOUT_ENTITYMANAGER_H
+// Entity component facade
+//  defined here rather than in Entity.h because it needs the complete EntityManager
+template<typename T>
+inline bool Entity::hasComponent() const {
+    return (_signature & signatureOf<T>) != 0;
+}
+
+
+template<typename T, typename... TArgs>
+inline T& Entity::addComponent(TArgs &&... mArgs) {
+    auto& component = _manager->getPool<T>().emplace(_id, std::forward<TArgs>(mArgs)...);
+    if (!hasComponent<T>()) {
+        _signature |= signatureOf<T>;
+        _manager->refreshViews(*this);
+    }
+    return component;
+}
+
+
+template<typename T>
+inline bool Entity::removeComponent() {
+    if (!hasComponent<T>())
+        return false;
+
+    _manager->getPool<T>().remove(_id);
+    _signature &= ~signatureOf<T>;
+    _manager->refreshViews(*this);
+    return true;
+}
 
+
+// the entity must have a T, check with hasComponent<T>() first
+template<typename T>
+inline T& Entity::getComponent() {
+    return _manager->getPool<T>().get(_id);
+}
+
+
+template<typename T>
+inline const T& Entity::getComponent() const {
+    return _manager->getPool<T>().get(_id);
+}
+
+
+template<typename... Ts>
+template<typename Fn>
+inline void View<Ts...>::each(Fn&& fn) {
+    for (const auto& h : _cache->entities)
+        fn(_manager->slot(h.index), _manager->getPool<Ts>().get(h.index)...);
+}
+
+
+#endif //BREAKOUT_ENTITYMANAGER_H
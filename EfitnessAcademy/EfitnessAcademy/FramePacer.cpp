@@ -0,0 +1,64 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <thread>
+
+
+FramePacer::FramePacer(unsigned int framesPerSecond)
+{
+	setTargetRate(framesPerSecond);
+}
+
+void FramePacer::setTargetRate(unsigned int framesPerSecond)
+{
+	if (framesPerSecond == 0)
+		_frameTime = Clock::duration::zero();
+	else
+		_frameTime = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond));
+	reset();
+}
+
+void FramePacer::setSpinTime(sf::Time spin)
+{
+	_spinTime = std::chrono::microseconds(spin.asMicroseconds());
+}
+
+void FramePacer::wait()
+{
+	if (_frameTime == Clock::duration::zero())
+		return;
+
+	_next += _frameTime;
+
+	// late by more than a frame, start again from now
+	auto now = Clock::now();
+	if (now > _next + _frameTime) {
+		_next = now;
+		return;
+	}
+
+	if (_next - now > _spinTime)
+		std::this_thread::sleep_for(_next - now - _spinTime);
+
+	while (Clock::now() < _next)
+		std::this_thread::yield();
+}
+
+void FramePacer::reset()
+{
+	_next = Clock::now();
+}
+
+
+bool waitEvent(sf::Window& window, sf::Event& event, sf::Time timeout)
+{
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout.asMicroseconds());
+	const auto step = std::chrono::milliseconds(5);
+
+	while (!window.pollEvent(event)) {
+		const auto now = std::chrono::steady_clock::now();
+		if (now >= deadline)
+			return false;
+		std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(step, deadline - now));
+	}
+	return true;
+}
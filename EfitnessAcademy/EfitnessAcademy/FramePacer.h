@@ -0,0 +1,39 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+
+
+// Holds a loop to a target frame rate
+//  wait() sleeps until shortly before the next frame is due and spins the
+//  rest of the way, because a plain sleep can overshoot by a millisecond or
+//  more. A frame that runs late resets the schedule rather than rushing the
+//  next frames to catch up.
+class FramePacer
+{
+private:
+	using Clock = std::chrono::steady_clock;
+
+	Clock::duration		_frameTime{ 0 };
+	Clock::duration		_spinTime{ std::chrono::milliseconds(2) };
+	Clock::time_point	_next{ Clock::now() };
+
+public:
+	// 0 = no limit, wait() returns straight away
+	explicit FramePacer(unsigned int framesPerSecond = 60);
+
+	void			setTargetRate(unsigned int framesPerSecond);
+
+	// how much of each frame is spun instead of slept
+	void			setSpinTime(sf::Time spin);
+
+	void			wait();
+
+	// the schedule starts over from now, call after the loop was idle
+	void			reset();
+};
+
+
+// like sf::Window::waitEvent but gives up after timeout
+//  SFML 2 has no timed wait, so this polls with short sleeps in between
+bool waitEvent(sf::Window& window, sf::Event& event, sf::Time timeout);
@@ -1,62 +1,88 @@
 #include "GameEngine.h"
 #include "Assets.h"
+#include "Scene_Loading.h"
 #include "Scene_Menu.h"
 #include "Command.h"
-#include <fstream>
 #include <memory>
 #include <cstdlib>
 #include <iostream>
+#include <thread>
 
 
-GameEngine::GameEngine(const std::string& path)
+GameEngine::GameEngine(const std::string& path, bool headless) : _headless(headless)
 {
-	Assets::getInstance().loadFromFile("../config.txt");
-	init(path);
+	// one pass over the config for the engine settings and the assets
+	auto& assets = Assets::getInstance();
+	assets.setHeadless(headless);
+	ConfigParser config;
+	assets.addConfigDirectives(config);
+	addConfigDirectives(config);
+	config.parseFile(path);
+	init();
 }
 
-
-void GameEngine::init(const std::string& path)
+GameEngine::~GameEngine()
 {
-	unsigned int width;
-	unsigned int height;
-	loadConfigFromFile(path, width, height);
+	// loads still queued would run on a JobSystem that is gone
+	Assets::getInstance().cancelLoading();
+}
 
 
-	_window.create(sf::VideoMode(width, height), "Emotional Fitness Academy");
+void GameEngine::init()
+{
+#if EFA_PROFILE
+	// before any worker can, so the profiler knows this thread as the main one
+	Profiler::getInstance();
+#endif
+	_jobs = std::make_unique<JobSystem>(_workerThreads);
+
+	// the files decode on the workers while the window is already up
+	auto& assets = Assets::getInstance();
+	assets.finishConfig(_jobs.get());
 
-	_statisticsText.setFont(Assets::getInstance().getFont("main"));
 	_statisticsText.setPosition(15.0f, 5.0f);
 	_statisticsText.setCharacterSize(15);
 
-	changeScene("MENU", std::make_shared<Scene_Menu>(this));
+	if (_headless) {
+		assets.finishLoading();
+		_statisticsText.setFont(assets.getFont("main"_asset));
+		changeScene("MENU", std::make_shared<Scene_Menu>(this));
+		return;
+	}
+
+	_window.create(sf::VideoMode(_configSize.x, _configSize.y), "Emotional Fitness Academy");
+	_window.setVerticalSyncEnabled(_vsync);
+
+	changeScene("LOADING", std::make_shared<Scene_Loading>(this));
 }
 
-void GameEngine::loadConfigFromFile(const std::string& path, unsigned int& width, unsigned int& height) const {
-	std::ifstream config(path);
-	if (config.fail()) {
-		std::cerr << "Open file " << path << " failed\n";
-		config.close();
-		exit(1);
-	}
-	std::string token{ "" };
-	config >> token;
-	while (!config.eof()) {
-		if (token == "Window") {
-			config >> width >> height;
-		}
-		else if (token[0] == '#') {
-			std::string tmp;
-			std::getline(config, tmp);
-			std::cout << tmp << "\n";
-		}
+// on the main thread at the top of every frame, uploads what the workers have decoded
+void GameEngine::sLoading()
+{
+	auto& assets = Assets::getInstance();
+	if (!assets.isLoading())
+		return;
 
-		if (config.fail()) {
-			config.clear(); // clear error on stream
-			std::cout << "*** Error reading config file\n";
-		}
-		config >> token;
-	}
-	config.close();
+	if (!assets.pumpLoading(_loadBudget))
+		_statisticsText.setFont(assets.getFont("main"_asset));
+}
+
+void GameEngine::addConfigDirectives(ConfigParser& config)
+{
+	config.on("Window", [this](ConfigLine& line) {
+		_configSize.x = line.read<unsigned int>("width");
+		_configSize.y = line.read<unsigned int>("height");
+	});
+	config.on("Workers", [this](ConfigLine& line) { _workerThreads = line.read<decltype(_workerThreads)>("worker count"); });
+	config.on("Pipeline", [this](ConfigLine& line) { _pipelined = line.read<bool>("pipeline flag"); });
+	config.on("SimulationSpeed", [this](ConfigLine& line) { _simulationSpeed = line.read<decltype(_simulationSpeed)>("simulation speed"); });
+	config.on("FrameRate", [this](ConfigLine& line) { _frameRate = line.read<decltype(_frameRate)>("frame rate"); });
+	config.on("VSync", [this](ConfigLine& line) { _vsync = line.read<bool>("vsync flag"); });
+	config.on("Idle", [this](ConfigLine& line) { _idleMode = line.read<bool>("idle flag"); });
+	config.on("Profiler", [this](ConfigLine& line) {
+		_showStatistics = line.read<bool>("overlay flag");
+		_tracePath = line.read<std::string>("trace path");
+	});
 }
 
 void GameEngine::update()
@@ -67,25 +93,61 @@ void GameEngine::update()
 
 }
 
-void GameEngine::sUserInput()
+bool GameEngine::sUserInput()
 {
+	bool any{ false };
 	sf::Event event;
 	while (_window.pollEvent(event))
 	{
-		if (event.type == sf::Event::Closed)
-			quit();
+		handleEvent(event);
+		any = true;
+	}
+	return any;
+}
 
-		if (event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased)
-		{
-			if (currentScene()->getActionMap().contains(event.key.code))
-			{
-				const std::string actionType = (event.type == sf::Event::KeyPressed) ? "START" : "END";
-				currentScene()->doAction(Command(currentScene()->getActionMap().at(event.key.code), actionType));
-			}
+void GameEngine::handleEvent(const sf::Event& event)
+{
+	if (event.type == sf::Event::Closed)
+		quit();
+
+	if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+		_showStatistics = !_showStatistics;
+		return;
+	}
+
+#if EFA_PROFILE
+	if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F4) {
+		auto& profiler = Profiler::getInstance();
+		if (profiler.isCapturing())
+			profiler.stopCapture(_tracePath);
+		else
+			profiler.startCapture();
+		return;
+	}
+#endif
+
+	if (event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased)
+	{
+		const bool pressed = (event.type == sf::Event::KeyPressed);
+		if (_pipelined) {
+			std::lock_guard<std::mutex> lock(_inputMutex);
+			_inputQueue.emplace_back(event.key.code, pressed);
+		}
+		else {
+			dispatchInput(event.key.code, pressed);
 		}
 	}
 }
 
+void GameEngine::dispatchInput(int key, bool pressed)
+{
+	if (currentScene()->getActionMap().contains(key))
+	{
+		const std::string actionType = pressed ? "START" : "END";
+		currentScene()->doAction(Command(currentScene()->getActionMap().at(key), actionType));
+	}
+}
+
 std::shared_ptr<Scene> GameEngine::currentScene()
 {
 	return _sceneMap.at(_currentScene);
@@ -103,34 +165,243 @@ void GameEngine::changeScene(const std::string& sceneName, std::shared_ptr<Scene
 }
 
 
+// the window is closed by run() on the main thread
 void GameEngine::quit()
 {
-	_window.close();
+	_running = false;
 }
 
 
 void GameEngine::run()
 {
-	const sf::Time SPF = sf::seconds(1.0f / 60.f);  // seconds per frame for 60 fps
+	if (_headless) {
+		runHeadless(0);
+		return;
+	}
+
+	if (_pipelined) {
+		runPipelined();
+		_window.close();
+		return;
+	}
+
+	const sf::Time SPF = _timeStep;					// seconds per frame for 60 fps
 
 	sf::Clock clock;
+	sf::Clock frameClock;
 	sf::Time timeSinceLastUpdate = sf::Time::Zero;
+	FramePacer pacer(_frameRate);
+	bool redraw{ true };
+	const Scene* drawn{ nullptr };					// a scene change always redraws
 
 	while (isRunning())
 	{
-		sUserInput();								// get user input
+		{
+			PROFILE_SCOPE("Input");
+			redraw |= sUserInput();					// get user input
+		}
+		sLoading();
 
 		timeSinceLastUpdate += clock.restart();
-		while (timeSinceLastUpdate > SPF)
 		{
-			currentScene()->update(SPF);			// update world
-			timeSinceLastUpdate -= SPF;
+			PROFILE_SCOPE("Update");
+			while (timeSinceLastUpdate > SPF)
+			{
+				currentScene()->simulate(_simulationSpeed);	// update world
+				timeSinceLastUpdate -= SPF;
+			}
 		}
 
-		window().clear(sf::Color::Cyan);
-		currentScene()->sRender();					// render world
-		window().display();
+		auto scene = currentScene();
+		if (redraw || scene.get() != drawn || !_idleMode || !scene->isIdle())
+		{
+			{
+				PROFILE_SCOPE("Render");
+				window().clear(sf::Color::Cyan);
+				scene->sRender();					// render world
+				_renderQueue.submit(_window);
+				drawStatistics();
+				window().display();
+			}
+			Assets::getInstance().collect();
+			drawn = scene.get();
+			redraw = false;
+			PROFILE_END_FRAME();
+			updateStatistics(frameClock.restart());
+			pacer.wait();
+		}
+		else
+		{
+			// nothing is moving, sleep until something happens
+			sf::Event event;
+			if (waitEvent(_window, event, _idleTimeout)) {
+				handleEvent(event);
+				redraw = true;
+			}
+			clock.restart();
+			frameClock.restart();
+			pacer.reset();
+		}
 	}
+	_window.close();
+}
+
+void GameEngine::runPipelined()
+{
+	std::thread simulation(&GameEngine::simulationLoop, this);
+	FramePacer pacer(_frameRate);
+	sf::Clock frameClock;
+
+	// draw frame N while the simulation steps frame N+1
+	while (isRunning())
+	{
+		{
+			PROFILE_SCOPE("Input");
+			sUserInput();
+		}
+		sLoading();
+
+		if (_snapshots.acquire()) {
+			{
+				PROFILE_SCOPE("Render");
+				drawSnapshot(_snapshots.front());
+				_renderQueue.submit(_window);
+				drawStatistics();
+				window().display();
+			}
+			Assets::getInstance().collect();
+			PROFILE_END_FRAME();
+			updateStatistics(frameClock.restart());
+			pacer.wait();
+		}
+		else {
+			sf::sleep(sf::milliseconds(1));
+		}
+	}
+
+	_running = false;
+	simulation.join();
+}
+
+void GameEngine::simulationLoop()
+{
+	const sf::Time SPF = _timeStep;
+
+	sf::Clock clock;
+	sf::Time timeSinceLastUpdate = sf::Time::Zero;
+	std::vector<std::pair<int, bool>> input;
+	size_t frame{ 0 };
+
+	while (_running)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_inputMutex);
+			input.swap(_inputQueue);
+		}
+		for (const auto& [key, pressed] : input)
+			dispatchInput(key, pressed);
+		input.clear();
+
+		timeSinceLastUpdate += clock.restart();
+		if (timeSinceLastUpdate <= SPF) {
+			sf::sleep(SPF - timeSinceLastUpdate);
+			continue;
+		}
+
+		{
+			PROFILE_SCOPE("Update");
+			while (timeSinceLastUpdate > SPF)
+			{
+				currentScene()->simulate(_simulationSpeed);
+				timeSinceLastUpdate -= SPF;
+			}
+		}
+
+		// the render thread is at most one snapshot behind
+		auto& snapshot = _snapshots.back();
+		snapshot.clear();
+		snapshot.frame = ++frame;
+		currentScene()->sSnapshot(snapshot);
+		_snapshots.publish();
+	}
+}
+
+GameEngine::HeadlessStats GameEngine::runHeadless(size_t frames, const std::function<bool(GameEngine&)>& until)
+{
+	HeadlessStats stats;
+	sf::Clock clock;
+
+	while (_running && (frames == 0 || stats.frames < frames) && !(until && until(*this)))
+	{
+		{
+			PROFILE_SCOPE("Update");
+			currentScene()->simulate(1);
+		}
+		Assets::getInstance().collect();
+		PROFILE_END_FRAME();
+		stats.frames++;
+	}
+
+	stats.wallTime = clock.getElapsedTime();
+	const float seconds = stats.wallTime.asSeconds();
+	stats.framesPerSecond = (seconds > 0.f) ? stats.frames / seconds : 0.0;
+
+	std::cout << "Simulated " << stats.frames << " frames in " << seconds << "s, "
+		<< stats.framesPerSecond << " frames/s\n";
+	return stats;
+}
+
+void GameEngine::drawSnapshot(const RenderSnapshot& snapshot)
+{
+	_renderQueue.setClearColor(snapshot.clearColor);
+	_renderQueue.setView(snapshot.view);
+
+	for (const auto& s : snapshot.sprites)
+		_renderQueue.draw(s.sprite, s.layer);
+	for (const auto& shape : snapshot.rectangles)
+		_renderQueue.draw(shape);
+	for (const auto& text : snapshot.texts)
+		_renderQueue.draw(text, RenderQueue::TopLayer);
+	reportCulling(snapshot.sprites.size(), snapshot.culled);
+}
+
+// refreshed twice a second, rebuilding the text every frame would cost more than what it measures
+void GameEngine::updateStatistics(sf::Time dt)
+{
+	_statisticsUpdateTime += dt;
+	_statisticsNumFrames += 1;
+	if (_statisticsUpdateTime < sf::seconds(0.5f))
+		return;
+
+	if (_showStatistics) {
+		const float seconds = _statisticsUpdateTime.asSeconds();
+		std::string text = "FPS: " + std::to_string(static_cast<int>(_statisticsNumFrames / seconds))
+			+ "   frame: " + std::to_string(1000.f * seconds / _statisticsNumFrames) + " ms\n"
+			+ "sprites: " + std::to_string(_spritesDrawn) + " drawn, " + std::to_string(_spritesCulled)
+			+ " culled, " + std::to_string(_renderQueue.drawCalls()) + " draw calls, "
+			+ std::to_string(_renderQueue.commandCount()) + " commands\n";
+		const ResidencyStats residency = Assets::getInstance().residency();
+		text += "assets: " + std::to_string(residency.residentBytes >> 20) + " MB resident"
+			+ (residency.budgetBytes ? " of " + std::to_string(residency.budgetBytes >> 20) + " MB" : std::string())
+			+ ", " + std::to_string(residency.residentTextures) + "/" + std::to_string(residency.textures) + " textures, "
+			+ std::to_string(residency.evictions) + " evicted\n";
+#if EFA_PROFILE
+		text += Profiler::getInstance().overlayText();
+#endif
+		_statisticsText.setString(text);
+	}
+
+	_statisticsUpdateTime = sf::Time::Zero;
+	_statisticsNumFrames = 0;
+}
+
+void GameEngine::drawStatistics()
+{
+	if (!_showStatistics)
+		return;
+
+	_window.setView(_window.getDefaultView());
+	_window.draw(_statisticsText);
 }
 
 void GameEngine::quitLevel()
@@ -150,9 +421,32 @@ sf::RenderWindow& GameEngine::window()
 }
 
 sf::Vector2f GameEngine::windowSize() const {
+	if (_headless)
+		return sf::Vector2f{ _configSize };
 	return sf::Vector2f{ _window.getSize() };
 }
 
+RenderQueue& GameEngine::renderQueue()
+{
+	return _renderQueue;
+}
+
+void GameEngine::reportCulling(size_t drawn, size_t culled)
+{
+	_spritesDrawn = drawn;
+	_spritesCulled = culled;
+}
+
+sf::Time GameEngine::timeStep() const
+{
+	return _timeStep;
+}
+
+JobSystem& GameEngine::jobs()
+{
+	return *_jobs;
+}
+
 
 bool GameEngine::isRunning()
 {
@@ -2,9 +2,20 @@
 
 
 #include "Assets.h"
+#include "ConfigParser.h"
+#include "JobSystem.h"
+#include "RenderSnapshot.h"
+#include "RenderQueue.h"
+#include "TripleBuffer.h"
+#include "FramePacer.h"
+#include "Profiler.h"
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <vector>
 
 class Scene;
 
@@ -17,34 +28,95 @@ public:
 	sf::RenderWindow	        _window;
 	std::string			        _currentScene;
 	SceneMap			        _sceneMap;
-	size_t				        _simulationSpeed{ 1 };
-	bool				        _running{ true };
+	size_t				        _simulationSpeed{ 1 };		// fixed steps per frame, > 1 fast-forwards
+	sf::Time					_timeStep{ sf::seconds(1.0f / 60.f) };
+	bool						_headless{ false };			// no window, nothing is drawn
+	sf::Vector2u				_configSize{ 0, 0 };
+	std::atomic<bool>	        _running{ true };
+	size_t						_workerThreads{ 0 };		// 0 = one per hardware thread
+	std::unique_ptr<JobSystem>	_jobs;
+
+	// Pipelined mode
+	//  the scenes update on a simulation thread and publish a RenderSnapshot,
+	//  the main thread handles window events and draws the newest snapshot.
+	//  Key events are queued for the simulation thread
+	bool								_pipelined{ false };
+	TripleBuffer<RenderSnapshot>		_snapshots;
+	std::mutex							_inputMutex;
+	std::vector<std::pair<int, bool>>	_inputQueue;			// key code, pressed
+
+	// scenes submit what they draw here, run() sorts and draws it once per frame
+	RenderQueue					_renderQueue;
+
+	// Frame pacing
+	//  frames are held to _frameRate (0 = no limit). In idle mode a scene that
+	//  reports isIdle() is drawn once and then only after an event, the loop
+	//  sleeps on window events for up to _idleTimeout in between
+	unsigned int				_frameRate{ 60 };
+	bool						_vsync{ false };
+	bool						_idleMode{ true };
+	sf::Time					_idleTimeout{ sf::milliseconds(250) };
 
 	// stats
+	//  F3 shows the frame rate and the profiler's per scope breakdown, F4 starts
+	//  and stops a Chrome trace capture written to _tracePath
 	sf::Text					_statisticsText;
 	sf::Time					_statisticsUpdateTime{ sf::Time::Zero };
 	unsigned int				_statisticsNumFrames{ 0 };
+	bool						_showStatistics{ false };
+	size_t						_spritesDrawn{ 0 };		// after culling, in the last frame
+	size_t						_spritesCulled{ 0 };
+	std::string					_tracePath{ "profile_trace.json" };
+
+	// time the main thread spends each frame finishing assets the workers loaded
+	sf::Time					_loadBudget{ sf::milliseconds(8) };
 
 public:
-	void					init(const std::string& path);
+	void					init();
+	void					addConfigDirectives(ConfigParser& config);
+	void					sLoading();
 	void					update();
-	void					sUserInput();
+	bool					sUserInput();			// true if there were any events
+	void					handleEvent(const sf::Event& event);
+	void					dispatchInput(int key, bool pressed);
+	void					simulationLoop();
+	void					runPipelined();
+	void					updateStatistics(sf::Time dt);
+	void					drawStatistics();
 	std::shared_ptr<Scene>	currentScene();
 
 public:
 
-	GameEngine(const std::string& path);
+	// frames simulated by runHeadless and how fast
+	struct HeadlessStats {
+		size_t		frames{ 0 };
+		sf::Time	wallTime{ sf::Time::Zero };
+		double		framesPerSecond{ 0.0 };
+	};
+
+	// headless never opens a window and loads no textures, for soak tests,
+	// benchmarks and replays on machines without a display
+	GameEngine(const std::string& path, bool headless = false);
+	~GameEngine();
 	;
 	void				changeScene(const std::string& sceneName,
 		std::shared_ptr<Scene> scene,
 		bool endCurrentScene = false);
 	void				quit();
 	void				run();
+
+	// step the current scene as fast as the CPU allows, for frames steps
+	// (0 = no limit) or until until() returns true or the game quits
+	HeadlessStats		runHeadless(size_t frames,
+		const std::function<bool(GameEngine&)>& until = {});
 	void				quitLevel();
 	void				backLevel();
 	sf::RenderWindow& window();
 	sf::Vector2f		windowSize() const;
+	sf::Time			timeStep() const;
+	void				drawSnapshot(const RenderSnapshot& snapshot);		// into the render queue
+	RenderQueue&		renderQueue();
+	void				reportCulling(size_t drawn, size_t culled);
+	JobSystem&			jobs();
 	bool				isRunning();
-	void				loadConfigFromFile(const std::string& path,
-		unsigned int& width, unsigned int& height) const;
 };
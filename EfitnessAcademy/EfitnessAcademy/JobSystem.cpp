@@ -0,0 +1,150 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <tuple>
+
+
+namespace {
+	// which JobSystem thread this is, threads it did not start count as thread 0
+	thread_local const JobSystem* t_owner{ nullptr };
+	thread_local size_t t_threadIndex{ 0 };
+}
+
+
+JobSystem::JobSystem(size_t threads)
+{
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+
+	for (size_t i{ 0 }; i < threads; ++i)
+		_queues.push_back(std::make_unique<Queue>());
+
+	for (size_t i{ 1 }; i < threads; ++i)
+		_workers.emplace_back([this, i]() { workerLoop(i); });
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_running = false;
+	}
+	_wake.notify_all();
+
+	for (auto& worker : _workers)
+		worker.join();
+}
+
+size_t JobSystem::threadCount() const
+{
+	return _queues.size();
+}
+
+size_t JobSystem::currentThread() const
+{
+	return (t_owner == this) ? t_threadIndex : 0;
+}
+
+void JobSystem::submit(Job job, JobCounter& counter)
+{
+	counter._pending.fetch_add(1, std::memory_order_relaxed);
+
+	// single threaded, run it now so the order is the submission order
+	if (_workers.empty()) {
+		job();
+		counter._pending.fetch_sub(1, std::memory_order_release);
+		return;
+	}
+
+	auto& queue = *_queues[currentThread()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.emplace_back(std::move(job), &counter);
+	}
+
+	_queued.fetch_add(1, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+	}
+	_wake.notify_one();
+}
+
+bool JobSystem::pop(size_t thread, Job& job, JobCounter*& counter)
+{
+	// newest job from our own queue, it is most likely still in cache
+	{
+		auto& queue = *_queues[thread];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty()) {
+			std::tie(job, counter) = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			_queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	// steal the oldest job from someone else
+	for (size_t i{ 1 }; i < _queues.size(); ++i) {
+		auto& queue = *_queues[(thread + i) % _queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty()) {
+			std::tie(job, counter) = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			_queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool JobSystem::runOne(size_t thread)
+{
+	Job job;
+	JobCounter* counter{ nullptr };
+	if (!pop(thread, job, counter))
+		return false;
+
+	job();
+	counter->_pending.fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+	// help out instead of blocking, the jobs we wait on may be in our own queue
+	const size_t thread = currentThread();
+	while (!counter.isDone()) {
+		if (!runOne(thread))
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::workerLoop(size_t thread)
+{
+	t_owner = this;
+	t_threadIndex = thread;
+
+	while (_running) {
+		if (runOne(thread))
+			continue;
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_wake.wait(lock, [this]() { return !_running || _queued.load(std::memory_order_acquire) > 0; });
+	}
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn)
+{
+	grain = std::max<size_t>(grain, 1);
+	if (_workers.empty() || count <= grain) {
+		for (size_t begin{ 0 }; begin < count; begin += grain)
+			fn(begin, std::min(begin + grain, count));
+		return;
+	}
+
+	JobCounter counter;
+	for (size_t begin{ 0 }; begin < count; begin += grain) {
+		const size_t end = std::min(begin + grain, count);
+		submit([&fn, begin, end]() { fn(begin, end); }, counter);
+	}
+	wait(counter);
+}
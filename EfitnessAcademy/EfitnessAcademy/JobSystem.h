@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// counts the unfinished jobs of a batch, wait() on it to join the batch
+class JobCounter
+{
+private:
+	friend class JobSystem;
+	std::atomic<size_t>		_pending{ 0 };
+
+public:
+	bool					isDone() const { return _pending.load(std::memory_order_acquire) == 0; }
+};
+
+
+// Work-stealing job system
+//  every thread has its own queue, it pushes and pops at the back and steals
+//  from the front of the others' queues when it runs dry. The thread that owns
+//  the JobSystem is thread 0 and runs jobs while it waits. With one thread no
+//  workers are started and every job runs inline, in submission order.
+class JobSystem
+{
+public:
+	using Job = std::function<void()>;
+
+private:
+	struct Queue {
+		std::mutex			mutex;
+		std::deque<std::pair<Job, JobCounter*>>	jobs;
+	};
+
+	std::vector<std::unique_ptr<Queue>>	_queues;
+	std::vector<std::thread>	_workers;
+	std::atomic<bool>			_running{ true };
+	std::atomic<size_t>			_queued{ 0 };
+	std::mutex					_sleepMutex;
+	std::condition_variable		_wake;
+
+	bool					pop(size_t thread, Job& job, JobCounter*& counter);
+	bool					runOne(size_t thread);
+	void					workerLoop(size_t thread);
+	size_t					currentThread() const;
+
+public:
+	// threads includes the calling thread, 0 means one per hardware thread
+	explicit JobSystem(size_t threads = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	size_t					threadCount() const;
+
+	void					submit(Job job, JobCounter& counter);
+	void					wait(JobCounter& counter);
+
+	// fn(begin, end) over [0, count) in chunks of at most grain, returns when all are done
+	void					parallelFor(size_t count, size_t grain,
+		const std::function<void(size_t, size_t)>& fn);
+};
@@ -0,0 +1,157 @@
+#include "MappedFile.h"
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+MappedFile::~MappedFile()
+{
+	release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other) {
+		release();
+		_data = std::exchange(other._data, nullptr);
+		_size = std::exchange(other._size, 0);
+#if defined(_WIN32)
+		_file = std::exchange(other._file, nullptr);
+		_mapping = std::exchange(other._mapping, nullptr);
+#else
+		_file = std::exchange(other._file, -1);
+#endif
+	}
+	return *this;
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const std::string& path)
+{
+	release();
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	_file = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		release();
+		return false;
+	}
+	_size = static_cast<size_t>(size.QuadPart);
+	if (_size == 0)
+		return true;		// nothing to map, a zero length mapping is an error
+
+	_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping)
+		_data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!_data) {
+		release();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::release()
+{
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_mapping)
+		CloseHandle(_mapping);
+	if (_file)
+		CloseHandle(_file);
+	_data = nullptr;
+	_size = 0;
+	_mapping = nullptr;
+	_file = nullptr;
+}
+
+bool MappedFile::isOpen() const
+{
+	return _file != nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path)
+{
+	release();
+
+	_file = ::open(path.c_str(), O_RDONLY);
+	if (_file < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(_file, &info) != 0) {
+		release();
+		return false;
+	}
+	_size = static_cast<size_t>(info.st_size);
+	if (_size == 0)
+		return true;		// nothing to map, a zero length mapping is an error
+
+	void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _file, 0);
+	if (data == MAP_FAILED) {
+		release();
+		return false;
+	}
+	madvise(data, _size, MADV_SEQUENTIAL);
+	_data = static_cast<const char*>(data);
+	return true;
+}
+
+void MappedFile::release()
+{
+	if (_data)
+		munmap(const_cast<char*>(_data), _size);
+	if (_file >= 0)
+		::close(_file);
+	_data = nullptr;
+	_size = 0;
+	_file = -1;
+}
+
+bool MappedFile::isOpen() const
+{
+	return _file >= 0;
+}
+
+#endif
+
+void MappedFile::close()
+{
+	release();
+}
+
+const char* MappedFile::data() const
+{
+	return _data;
+}
+
+size_t MappedFile::size() const
+{
+	return _size;
+}
+
+std::string_view MappedFile::view() const
+{
+	return _data ? std::string_view(_data, _size) : std::string_view();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+
+// Read only view of a whole file mapped into memory
+//  the OS pages the file in as it is read, nothing is copied. An empty file
+//  maps to an empty view. Move only, the mapping is released with the object.
+class MappedFile
+{
+private:
+	const char*		_data{ nullptr };
+	size_t			_size{ 0 };
+#if defined(_WIN32)
+	void*			_file{ nullptr };
+	void*			_mapping{ nullptr };
+#else
+	int				_file{ -1 };
+#endif
+
+	void			release();
+
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	// false if the file can not be opened or mapped, the view is left empty
+	bool			open(const std::string& path);
+	void			close();
+
+	bool			isOpen() const;
+	const char*		data() const;
+	size_t			size() const;
+	std::string_view	view() const;
+};
@@ -0,0 +1,187 @@
+#include "MovementSystem.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define EFA_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC compiles intrinsics for any instruction set, gcc and clang need the target per function
+#if defined(EFA_X86) && !defined(_MSC_VER)
+#define EFA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define EFA_TARGET_AVX2
+#endif
+
+
+namespace {
+	// transforms per parallel job, a multiple of 8 so every chunk starts aligned
+	constexpr size_t MovementGrain{ 4096 };
+
+	bool cpuHasAvx2()
+	{
+#if defined(EFA_X86) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+
+		// the OS has to save the ymm registers too
+		__cpuid(info, 1);
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#elif defined(EFA_X86)
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#else
+		return false;
+#endif
+	}
+}
+
+
+void kernels::integrateScalar(float* values, const float* rates, size_t count, float dt)
+{
+	for (size_t i{ 0 }; i < count; ++i) {
+		const float step = rates[i] * dt;
+		values[i] = values[i] + step;
+	}
+}
+
+void kernels::integrateSse(float* values, const float* rates, size_t count, float dt)
+{
+#if defined(EFA_X86)
+	const __m128 step = _mm_set1_ps(dt);
+	size_t i{ 0 };
+	for (; i + 4 <= count; i += 4) {
+		const __m128 v = _mm_loadu_ps(values + i);
+		const __m128 r = _mm_loadu_ps(rates + i);
+		_mm_storeu_ps(values + i, _mm_add_ps(v, _mm_mul_ps(r, step)));
+	}
+	integrateScalar(values + i, rates + i, count - i, dt);
+#else
+	integrateScalar(values, rates, count, dt);
+#endif
+}
+
+EFA_TARGET_AVX2 void kernels::integrateAvx2(float* values, const float* rates, size_t count, float dt)
+{
+#if defined(EFA_X86)
+	const __m256 step = _mm256_set1_ps(dt);
+	size_t i{ 0 };
+	for (; i + 8 <= count; i += 8) {
+		const __m256 v = _mm256_loadu_ps(values + i);
+		const __m256 r = _mm256_loadu_ps(rates + i);
+		_mm256_storeu_ps(values + i, _mm256_add_ps(v, _mm256_mul_ps(r, step)));
+	}
+	// the compiler leaves the upper ymm halves dirty before a tail call, legacy SSE
+	// code after it, libm's included, would then pay a state transition on every instruction
+	_mm256_zeroupper();
+	integrateSse(values + i, rates + i, count - i, dt);
+#else
+	integrateScalar(values, rates, count, dt);
+#endif
+}
+
+IntegrateKernel kernels::integrate()
+{
+	static const IntegrateKernel kernel = cpuHasAvx2() ? &integrateAvx2
+#if defined(EFA_X86)
+		: &integrateSse;
+#else
+		: &integrateScalar;
+#endif
+	return kernel;
+}
+
+const char* kernels::integrateName()
+{
+	const IntegrateKernel kernel = integrate();
+	if (kernel == &integrateAvx2)
+		return "avx2";
+	if (kernel == &integrateSse)
+		return "sse";
+	return "scalar";
+}
+
+
+void MovementSystem::pack(const CTransform* tfms, size_t begin, size_t end)
+{
+	float* x = _values.data();
+	float* y = x + _stride;
+	float* a = y + _stride;
+	float* vx = _rates.data();
+	float* vy = vx + _stride;
+	float* va = vy + _stride;
+
+	for (size_t i{ begin }; i < end; ++i) {
+		const auto& t = tfms[i];
+		x[i] = t.pos.x;
+		y[i] = t.pos.y;
+		a[i] = t.angle;
+		vx[i] = t.vel.x;
+		vy[i] = t.vel.y;
+		va[i] = t.angVel;
+	}
+}
+
+void MovementSystem::integrate(size_t begin, size_t end, float dt)
+{
+	const IntegrateKernel kernel = kernels::integrate();
+	for (size_t lane{ 0 }; lane < 3; ++lane) {
+		const size_t offset = lane * _stride + begin;
+		kernel(_values.data() + offset, _rates.data() + offset, end - begin, dt);
+	}
+}
+
+void MovementSystem::unpack(CTransform* tfms, size_t begin, size_t end) const
+{
+	const float* x = _values.data();
+	const float* y = x + _stride;
+	const float* a = y + _stride;
+
+	for (size_t i{ begin }; i < end; ++i) {
+		auto& t = tfms[i];
+		t.prevPos = t.pos;
+		t.pos.x = x[i];
+		t.pos.y = y[i];
+		t.angle = a[i];
+	}
+}
+
+void MovementSystem::update(EntityManager& entities, sf::Time dt)
+{
+	auto& pool = entities.getPool<CTransform>();
+	_stride = (pool.size() + 7) & ~size_t{ 7 };
+	_values.resize(3 * _stride);
+	_rates.resize(3 * _stride);
+
+	pack(pool.data(), 0, pool.size());
+	integrate(0, pool.size(), dt.asSeconds());
+	unpack(pool.data(), 0, pool.size());
+}
+
+void MovementSystem::update(EntityManager& entities, JobSystem& jobs, sf::Time dt)
+{
+	auto& pool = entities.getPool<CTransform>();
+	_stride = (pool.size() + 7) & ~size_t{ 7 };
+	_values.resize(3 * _stride);
+	_rates.resize(3 * _stride);
+
+	// chunks touch disjoint ranges of the pool and the lanes
+	CTransform* tfms = pool.data();
+	const float step = dt.asSeconds();
+	jobs.parallelFor(pool.size(), MovementGrain, [this, tfms, step](size_t begin, size_t end) {
+		pack(tfms, begin, end);
+		integrate(begin, end, step);
+		unpack(tfms, begin, end);
+	});
+}
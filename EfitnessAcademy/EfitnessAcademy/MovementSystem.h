@@ -0,0 +1,73 @@
+#pragma once
+
+#include "EntityManager.h"
+#include "JobSystem.h"
+#include <SFML/System.hpp>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+
+// allocator for float lanes the SIMD kernels load from
+template<typename T, size_t Align = 32>
+struct AlignedAllocator
+{
+	using value_type = T;
+
+	template<typename U>
+	struct rebind { using other = AlignedAllocator<U, Align>; };
+
+	AlignedAllocator() = default;
+	template<typename U>
+	AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+	T* allocate(size_t n) {
+		return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ Align }));
+	}
+	void deallocate(T* p, size_t) {
+		::operator delete(p, std::align_val_t{ Align });
+	}
+
+	template<typename U>
+	bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+	template<typename U>
+	bool operator!=(const AlignedAllocator<U, Align>&) const { return false; }
+};
+
+using FloatLanes = std::vector<float, AlignedAllocator<float>>;
+
+
+// values[i] += rates[i] * dt
+//  every kernel gives bit-identical results, they multiply then add, never fuse
+using IntegrateKernel = void (*)(float* values, const float* rates, size_t count, float dt);
+
+namespace kernels {
+	void	integrateScalar(float* values, const float* rates, size_t count, float dt);
+	void	integrateSse(float* values, const float* rates, size_t count, float dt);
+	void	integrateAvx2(float* values, const float* rates, size_t count, float dt);
+
+	// the fastest kernel this CPU supports, picked once at start up
+	IntegrateKernel	integrate();
+	const char*		integrateName();
+}
+
+
+// Integrates every CTransform, prevPos = pos, pos += vel * dt, angle += angVel * dt
+//  CTransform's floats are interleaved with its sf::Transformable, so they are
+//  packed into aligned lanes (x, y and angle with their rates), integrated with
+//  the SIMD kernel and written back. Walks the CTransform pool directly.
+class MovementSystem
+{
+private:
+	FloatLanes		_values;		// pos.x | pos.y | angle, each lane padded to a multiple of 8
+	FloatLanes		_rates;			// vel.x | vel.y | angVel
+	size_t			_stride{ 0 };
+
+	void			pack(const CTransform* tfms, size_t begin, size_t end);
+	void			integrate(size_t begin, size_t end, float dt);
+	void			unpack(CTransform* tfms, size_t begin, size_t end) const;
+
+public:
+	void			update(EntityManager& entities, sf::Time dt);
+	void			update(EntityManager& entities, JobSystem& jobs, sf::Time dt);
+};
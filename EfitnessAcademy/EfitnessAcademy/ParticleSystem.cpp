@@ -0,0 +1,278 @@
+#include "ParticleSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+namespace {
+	constexpr unsigned int TextureSize{ 64 };
+	constexpr float DegToRad{ 3.14159265f / 180.f };
+
+	const sf::BlendMode& blendOf(size_t pool)
+	{
+		return pool == static_cast<size_t>(ParticleBlend::Add) ? sf::BlendAdd : sf::BlendAlpha;
+	}
+
+	sf::Uint8 channel(float v)
+	{
+		return static_cast<sf::Uint8>(std::clamp(v, 0.f, 255.f));
+	}
+}
+
+
+ParticleSystem::Pool::Pool(size_t capacity)
+	: capacity(capacity)
+{
+	// a multiple of 8 keeps every lane 32 byte aligned, the extra 16 floats skew them by a cache line
+	const size_t stride = ((capacity + 7) & ~size_t{ 7 }) + 16;
+	lanes.resize(stride * LaneCount);
+	float** const named[LaneCount]{ &x, &y, &vx, &vy, &ax, &ay, &age, &ageRate, &sizeStart, &sizeDelta,
+		&r, &g, &b, &a, &dr, &dg, &db, &da };
+	for (size_t k{ 0 }; k < LaneCount; ++k)
+		*named[k] = lanes.data() + k * stride;
+
+	// top-left, top-right, bottom-right, bottom-left of the particle texture
+	const float t = static_cast<float>(TextureSize);
+	vertices.resize(capacity * 4);
+	for (size_t i{ 0 }; i < vertices.size(); i += 4) {
+		vertices[i + 0].texCoords = sf::Vector2f(0.f, 0.f);
+		vertices[i + 1].texCoords = sf::Vector2f(t, 0.f);
+		vertices[i + 2].texCoords = sf::Vector2f(t, t);
+		vertices[i + 3].texCoords = sf::Vector2f(0.f, t);
+	}
+}
+
+// the last particle takes the dead one's place
+void ParticleSystem::Pool::kill(size_t i)
+{
+	const size_t last = --count;
+	for (float* lane : { x, y, vx, vy, ax, ay, age, ageRate, sizeStart, sizeDelta,
+		r, g, b, a, dr, dg, db, da })
+		lane[i] = lane[last];
+}
+
+
+ParticleSystem::ParticleSystem(size_t capacity)
+	: _pools{ Pool(capacity), Pool(capacity) }
+{}
+
+// xorshift, plenty for effects and much cheaper than <random>
+float ParticleSystem::random(float lo, float hi)
+{
+	_rng ^= _rng << 13;
+	_rng ^= _rng >> 17;
+	_rng ^= _rng << 5;
+	return lo + (hi - lo) * static_cast<float>(_rng >> 8) * (1.f / 16777216.f);
+}
+
+EmitterId ParticleSystem::addEmitter(const EmitterDesc& desc)
+{
+	for (EmitterId id{ 0 }; id < _emitters.size(); ++id) {
+		if (!_emitters[id].alive) {
+			_emitters[id] = Emitter{ desc };
+			return id;
+		}
+	}
+	_emitters.push_back(Emitter{ desc });
+	return static_cast<EmitterId>(_emitters.size() - 1);
+}
+
+void ParticleSystem::removeEmitter(EmitterId id)
+{
+	_emitters.at(id).alive = false;
+	_emitters.at(id).active = false;
+}
+
+EmitterDesc& ParticleSystem::emitter(EmitterId id)
+{
+	return _emitters.at(id).desc;
+}
+
+void ParticleSystem::setActive(EmitterId id, bool active)
+{
+	auto& e = _emitters.at(id);
+	if (e.active != active)
+		e.pending = 0.f;
+	e.active = active;
+}
+
+void ParticleSystem::burst(EmitterId id, size_t count)
+{
+	spawn(_emitters.at(id).desc, count);
+}
+
+// a lane at a time, so each loop is one sequential stream the prefetcher keeps up
+// with. The random angles and speed go through the x, vx and vy lanes first
+void ParticleSystem::spawn(const EmitterDesc& desc, size_t count)
+{
+	Pool& pool = _pools[static_cast<size_t>(desc.blend)];
+	count = std::min(count, pool.capacity - pool.count);
+	const size_t first = pool.count;
+	const size_t end = first + count;
+	pool.count = end;
+
+	for (size_t i{ first }; i < end; ++i) {
+		const float around = random(0.f, 360.f) * DegToRad;
+		pool.x[i] = around;
+		pool.vx[i] = random(desc.angleMin, desc.angleMax) * DegToRad + (desc.radial ? around : 0.f);
+		pool.vy[i] = random(desc.speedMin, desc.speedMax);
+		pool.ageRate[i] = 1.f / std::max(random(desc.lifeMin, desc.lifeMax), 0.001f);
+	}
+	for (size_t i{ first }; i < end; ++i) {
+		const float around = pool.x[i];
+		pool.x[i] = desc.position.x + std::cos(around) * desc.spawnRadius;
+		pool.y[i] = desc.position.y + std::sin(around) * desc.spawnRadius;
+	}
+	for (size_t i{ first }; i < end; ++i) {
+		const float heading = pool.vx[i], speed = pool.vy[i];
+		pool.vx[i] = std::cos(heading) * speed;
+		pool.vy[i] = std::sin(heading) * speed;
+	}
+
+	const float cr = desc.colorStart.r, cg = desc.colorStart.g, cb = desc.colorStart.b, ca = desc.colorStart.a;
+	auto fill = [first, count](float* lane, float value) { std::fill_n(lane + first, count, value); };
+	fill(pool.ax, desc.acceleration.x);
+	fill(pool.ay, desc.acceleration.y);
+	fill(pool.age, 0.f);
+	fill(pool.sizeStart, desc.sizeStart);
+	fill(pool.sizeDelta, desc.sizeEnd - desc.sizeStart);
+	fill(pool.r, cr);
+	fill(pool.g, cg);
+	fill(pool.b, cb);
+	fill(pool.a, ca);
+	fill(pool.dr, desc.colorEnd.r - cr);
+	fill(pool.dg, desc.colorEnd.g - cg);
+	fill(pool.db, desc.colorEnd.b - cb);
+	fill(pool.da, desc.colorEnd.a - ca);
+}
+
+void ParticleSystem::simulate(Pool& pool, float dt)
+{
+	const IntegrateKernel integrate = kernels::integrate();
+	const size_t n = pool.count;
+
+	integrate(pool.vx, pool.ax, n, dt);
+	integrate(pool.vy, pool.ay, n, dt);
+	integrate(pool.x, pool.vx, n, dt);
+	integrate(pool.y, pool.vy, n, dt);
+	integrate(pool.age, pool.ageRate, n, dt);
+
+	// from the back, a swapped in particle has already been checked
+	for (size_t i{ n }; i-- > 0; ) {
+		if (pool.age[i] >= 1.f)
+			pool.kill(i);
+	}
+}
+
+void ParticleSystem::buildVertices(Pool& pool)
+{
+	// one pass over the lanes, size and colour at each particle's age go straight
+	// into its quad. Fields are written one by one, sf::Color's constructors are not inline
+	const size_t n = pool.count;
+	const float* x = pool.x;
+	const float* y = pool.y;
+	const float* age = pool.age;
+	const float* sizeStart = pool.sizeStart;
+	const float* sizeDelta = pool.sizeDelta;
+	const float* r = pool.r;
+	const float* g = pool.g;
+	const float* b = pool.b;
+	const float* a = pool.a;
+	const float* dr = pool.dr;
+	const float* dg = pool.dg;
+	const float* db = pool.db;
+	const float* da = pool.da;
+	sf::Vertex* v = pool.vertices.data();
+
+	for (size_t i{ 0 }; i < n; ++i, v += 4) {
+		const float half = 0.5f * (sizeStart[i] + sizeDelta[i] * age[i]);
+		const float left = x[i] - half, right = x[i] + half;
+		const float top = y[i] - half, bottom = y[i] + half;
+
+		// start + (end - start) * age with age in [0, 1) stays inside 0-255
+		const sf::Uint8 rgba[4]{
+			static_cast<sf::Uint8>(r[i] + dr[i] * age[i]),
+			static_cast<sf::Uint8>(g[i] + dg[i] * age[i]),
+			static_cast<sf::Uint8>(b[i] + db[i] * age[i]),
+			static_cast<sf::Uint8>(a[i] + da[i] * age[i]) };
+
+		v[0].position.x = left;
+		v[0].position.y = top;
+		v[1].position.x = right;
+		v[1].position.y = top;
+		v[2].position.x = right;
+		v[2].position.y = bottom;
+		v[3].position.x = left;
+		v[3].position.y = bottom;
+		for (size_t k{ 0 }; k < 4; ++k)
+			std::memcpy(&v[k].color, rgba, sizeof(rgba));
+	}
+}
+
+void ParticleSystem::update(float dt)
+{
+	for (auto& e : _emitters) {
+		if (!e.active)
+			continue;
+		e.pending += e.desc.rate * dt;
+		const size_t count = static_cast<size_t>(e.pending);
+		e.pending -= static_cast<float>(count);
+		spawn(e.desc, count);
+	}
+
+	for (auto& pool : _pools) {
+		simulate(pool, dt);
+		buildVertices(pool);
+	}
+}
+
+void ParticleSystem::clear()
+{
+	for (auto& pool : _pools)
+		pool.count = 0;
+	for (auto& e : _emitters)
+		e.pending = 0.f;
+}
+
+size_t ParticleSystem::liveCount() const
+{
+	return _pools[0].count + _pools[1].count;
+}
+
+size_t ParticleSystem::capacity() const
+{
+	return _pools[0].capacity;
+}
+
+// white disc fading from the centre, the vertex colour tints it
+const sf::Texture& ParticleSystem::texture() const
+{
+	if (!_texture) {
+		sf::Image image;
+		image.create(TextureSize, TextureSize, sf::Color::Transparent);
+		const float c = (TextureSize - 1) / 2.f;
+		for (unsigned int y{ 0 }; y < TextureSize; ++y) {
+			for (unsigned int x{ 0 }; x < TextureSize; ++x) {
+				const float d = std::hypot(x - c, y - c) / c;
+				const float falloff = std::max(0.f, 1.f - d);
+				image.setPixel(x, y, sf::Color(255, 255, 255, channel(255.f * falloff * falloff)));
+			}
+		}
+
+		_texture = std::make_unique<sf::Texture>();
+		_texture->loadFromImage(image);
+		_texture->setSmooth(true);
+	}
+	return *_texture;
+}
+
+void ParticleSystem::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	states.texture = &texture();
+	for (size_t p{ 0 }; p < 2; ++p) {
+		if (_pools[p].count == 0)
+			continue;
+		states.blendMode = blendOf(p);
+		target.draw(_pools[p].vertices.data(), _pools[p].count * 4, sf::Quads, states);
+	}
+}
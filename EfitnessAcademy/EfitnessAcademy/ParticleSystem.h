@@ -0,0 +1,105 @@
+#pragma once
+
+#include "MovementSystem.h"
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+enum class ParticleBlend : uint8_t { Alpha, Add };
+
+
+// what an emitter spawns, each particle draws its values uniformly from the ranges
+struct EmitterDesc
+{
+	sf::Vector2f	position{ 0.f, 0.f };
+	float			spawnRadius{ 0.f };			// spawned on a ring of this radius around position
+	float			rate{ 0.f };				// particles per second while active
+	float			lifeMin{ 1.f }, lifeMax{ 1.f };		// seconds
+	float			speedMin{ 0.f }, speedMax{ 0.f };
+	float			angleMin{ 0.f }, angleMax{ 360.f };	// degrees, 0 is +x
+	bool			radial{ false };			// angles are relative to the outward normal of the ring
+	sf::Vector2f	acceleration{ 0.f, 0.f };
+	float			sizeStart{ 8.f }, sizeEnd{ 0.f };
+	sf::Color		colorStart{ sf::Color::White };
+	sf::Color		colorEnd{ sf::Color::Transparent };
+	ParticleBlend	blend{ ParticleBlend::Add };
+};
+
+using EmitterId = uint32_t;
+
+
+// CPU particles
+//  particles are kept in structure-of-arrays pools of fixed capacity, one per
+//  blend mode, so the update is a handful of straight loops over aligned float
+//  lanes. Position and age advance through the MovementSystem SIMD kernel.
+//  Dead particles are swapped out, the live ones stay packed at the front.
+//  update() writes every live particle as a quad straight into one reused
+//  vertex buffer per blend mode. Each slot's texture coordinates never change
+//  and are set once, a frame only writes positions and colours. Drawing costs
+//  one draw call per blend mode with a shared soft round texture. Emitters
+//  spawn at their rate while active, burst() spawns at once.
+class ParticleSystem : public sf::Drawable
+{
+private:
+	// the lanes share one buffer, each starts a cache line further along than
+	// a power of two from the last. Lanes exactly 256 KB apart fell in the
+	// same cache sets, and spawn and kill, which touch every lane at one
+	// index, evicted each other
+	struct Pool {
+		static constexpr size_t	LaneCount{ 18 };
+
+		size_t			capacity{ 0 };
+		size_t			count{ 0 };
+		FloatLanes		lanes;
+		float*			x, * y, * vx, * vy, * ax, * ay;
+		float*			age, * ageRate;			// age runs 0 to 1, ageRate = 1 / lifetime
+		float*			sizeStart, * sizeDelta;
+		float*			r, * g, * b, * a;		// start colour, 0-255
+		float*			dr, * dg, * db, * da;	// end - start
+		std::vector<sf::Vertex>	vertices;		// sf::Quads, 4 per particle slot
+
+		explicit Pool(size_t capacity);
+		Pool(const Pool&) = delete;				// the lane pointers point into lanes
+		Pool& operator=(const Pool&) = delete;
+		void			kill(size_t i);
+	};
+
+	struct Emitter {
+		EmitterDesc		desc;
+		bool			active{ true };
+		bool			alive{ true };
+		float			pending{ 0.f };			// fractional particles carried to the next update
+	};
+
+	Pool						_pools[2];			// indexed by ParticleBlend
+	std::vector<Emitter>		_emitters;
+	mutable std::unique_ptr<sf::Texture>	_texture;	// made on the first draw, there may be no GL context before
+	uint32_t					_rng{ 0x9e3779b9u };
+
+	float			random(float lo, float hi);
+	void			spawn(const EmitterDesc& desc, size_t count);
+	void			simulate(Pool& pool, float dt);
+	void			buildVertices(Pool& pool);
+	const sf::Texture&	texture() const;
+
+	void			draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+public:
+	// particles per blend mode
+	explicit ParticleSystem(size_t capacity = 16384);
+
+	EmitterId		addEmitter(const EmitterDesc& desc);
+	void			removeEmitter(EmitterId id);
+	EmitterDesc&	emitter(EmitterId id);
+	void			setActive(EmitterId id, bool active);
+	void			burst(EmitterId id, size_t count);
+
+	// spawn, age, move and kill, then build the vertex arrays
+	void			update(float dt);
+	void			clear();
+
+	size_t			liveCount() const;
+	size_t			capacity() const;
+};
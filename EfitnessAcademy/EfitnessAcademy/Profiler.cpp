@@ -0,0 +1,194 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+// nothing is left to reference the profiler when it is compiled out
+#if EFA_PROFILE
+
+
+thread_local std::uint32_t ProfileScope::t_depth{ 0 };
+
+
+namespace {
+	std::string jsonEscape(std::string_view s)
+	{
+		std::string out;
+		out.reserve(s.size());
+		for (const char c : s) {
+			if (c == '"' || c == '\\')
+				out += '\\';
+			out += c;
+		}
+		return out;
+	}
+}
+
+
+// GameEngine asks for the instance first, on the main thread
+Profiler::Profiler()
+	: _epoch(Clock::now())
+	, _mainThread(std::this_thread::get_id())
+{}
+
+Profiler& Profiler::getInstance()
+{
+	static Profiler instance;          // Meyers Singleton implementation
+	return instance;
+}
+
+ProfileRing* Profiler::registerThread()
+{
+	std::lock_guard<std::mutex> lock(_ringMutex);
+	_rings.push_back(std::make_unique<ProfileRing>(static_cast<std::uint32_t>(_rings.size()), std::this_thread::get_id()));
+	return _rings.back().get();
+}
+
+const char* Profiler::intern(std::string_view name)
+{
+	std::lock_guard<std::mutex> lock(_ringMutex);
+	auto found = _names.find(name);
+	if (found == _names.end())
+		found = _names.emplace(name).first;
+	return found->c_str();
+}
+
+void Profiler::endFrame()
+{
+	_frameEvents.clear();
+	{
+		std::lock_guard<std::mutex> lock(_ringMutex);
+		for (auto& ring : _rings) {
+			ring->drain([this](const ProfileEvent& e) { _frameEvents.push_back(e); });
+			_dropped += ring->takeDropped();
+		}
+	}
+
+	// per thread in start order, a parent starts before its children
+	std::sort(_frameEvents.begin(), _frameEvents.end(), [](const ProfileEvent& a, const ProfileEvent& b) {
+		if (a.thread != b.thread)
+			return a.thread < b.thread;
+		if (a.start != b.start)
+			return a.start < b.start;
+		return a.depth < b.depth;
+	});
+
+	for (auto& [name, stat] : _stats) {
+		stat.calls = 0;
+		stat.frameMs = 0.0;
+	}
+
+	for (size_t i{ 0 }; i < _frameEvents.size(); ++i) {
+		const auto& e = _frameEvents[i];
+		auto found = _stats.find(std::string_view(e.name));
+		if (found == _stats.end()) {
+			found = _stats.emplace(e.name, Stat{}).first;
+			found->second.name = e.name;
+		}
+
+		auto& stat = found->second;
+		if (stat.calls == 0) {
+			stat.order = i;
+			stat.depth = e.depth;
+		}
+		stat.calls++;
+		stat.frameMs += (e.end - e.start) / 1e6;
+
+		if (_capturing)
+			_trace.push_back(TraceEvent{ stat.name, e.start, e.end - e.start, e.thread });
+	}
+
+	for (auto it = _stats.begin(); it != _stats.end(); ) {
+		auto& stat = it->second;
+		stat.history[stat.frames % Window] = stat.frameMs;
+		stat.frames++;
+
+		const size_t n = std::min(stat.frames, Window);
+		double sum{ 0.0 };
+		for (size_t i{ 0 }; i < n; ++i)
+			sum += stat.history[i];
+		stat.averageMs = sum / n;
+
+		// scopes of a scene that is gone
+		if (stat.calls == 0 && stat.averageMs == 0.0)
+			it = _stats.erase(it);
+		else
+			++it;
+	}
+
+	_frame++;
+}
+
+std::vector<const Profiler::Stat*> Profiler::stats() const
+{
+	std::vector<const Stat*> result;
+	for (const auto& [name, stat] : _stats) {
+		if (stat.calls > 0)
+			result.push_back(&stat);
+	}
+	std::sort(result.begin(), result.end(), [](const Stat* a, const Stat* b) { return a->order < b->order; });
+	return result;
+}
+
+std::string Profiler::overlayText() const
+{
+	std::string text = "scope                    frame ms   avg ms  calls\n";
+	char line[128];
+	for (const Stat* stat : stats()) {
+		const std::string name = std::string(stat->depth * 2, ' ') + stat->name;
+		std::snprintf(line, sizeof(line), "%-24.24s %8.3f %8.3f %6u\n",
+			name.c_str(), stat->frameMs, stat->averageMs, stat->calls);
+		text += line;
+	}
+
+	if (_dropped > 0)
+		text += std::to_string(_dropped) + " events dropped\n";
+	if (_capturing)
+		text += "capturing " + std::to_string(_trace.size()) + " events\n";
+	return text;
+}
+
+void Profiler::startCapture()
+{
+	_trace.clear();
+	_capturing = true;
+}
+
+bool Profiler::stopCapture(const std::string& path)
+{
+	_capturing = false;
+
+	std::ofstream out(path);
+	if (out.fail()) {
+		std::cerr << "Open file " << path << " failed\n";
+		return false;
+	}
+
+	// complete ("X") events in microseconds, one track per thread
+	out << "{\"traceEvents\":[\n";
+	bool first{ true };
+	{
+		std::lock_guard<std::mutex> lock(_ringMutex);
+		for (const auto& ring : _rings) {
+			out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->thread
+				<< ",\"args\":{\"name\":\"" << (ring->owner == _mainThread ? "main" : "thread " + std::to_string(ring->thread)) << "\"}}";
+			first = false;
+		}
+	}
+
+	char line[64];
+	for (const auto& e : _trace) {
+		std::snprintf(line, sizeof(line), "\"ts\":%.3f,\"dur\":%.3f,", e.start / 1e3, e.duration / 1e3);
+		out << (first ? "" : ",\n") << "{\"name\":\"" << jsonEscape(e.name) << "\",\"cat\":\"efa\",\"ph\":\"X\","
+			<< line << "\"pid\":1,\"tid\":" << e.thread << "}";
+		first = false;
+	}
+	out << "\n]}\n";
+
+	std::cout << "Wrote " << _trace.size() << " profile events to " << path << std::endl;
+	_trace.clear();
+	return true;
+}
+
+#endif // EFA_PROFILE
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+// build with EFA_PROFILE=0 to compile every PROFILE_ macro out
+#ifndef EFA_PROFILE
+#define EFA_PROFILE 1
+#endif
+
+
+struct ProfileEvent {
+	const char*		name;			// must outlive the frame, a literal or a name the owner keeps
+	std::uint64_t	start;			// ns since the profiler started
+	std::uint64_t	end;
+	std::uint32_t	depth;			// nesting on its thread
+	std::uint32_t	thread;
+};
+
+
+// one thread writes, the frame's end drains, neither blocks
+//  a full ring drops the event and counts it
+class ProfileRing
+{
+public:
+	static constexpr size_t Capacity{ 1 << 14 };
+
+private:
+	std::array<ProfileEvent, Capacity>	_events;
+	std::atomic<size_t>					_head{ 0 };		// next write, owned by the thread
+	std::atomic<size_t>					_tail{ 0 };		// next read, owned by the drain
+	std::atomic<size_t>					_dropped{ 0 };
+
+public:
+	const std::uint32_t					thread;
+	const std::thread::id				owner;			// the thread that writes
+
+	ProfileRing(std::uint32_t thread, std::thread::id owner) : thread(thread), owner(owner) {}
+
+	void			push(const ProfileEvent& e) {
+		const size_t head = _head.load(std::memory_order_relaxed);
+		if (head - _tail.load(std::memory_order_acquire) == Capacity) {
+			_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		_events[head % Capacity] = e;
+		_head.store(head + 1, std::memory_order_release);
+	}
+
+	template<typename Fn>
+	void			drain(Fn&& fn) {
+		const size_t head = _head.load(std::memory_order_acquire);
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		for (; tail != head; ++tail)
+			fn(_events[tail % Capacity]);
+		_tail.store(tail, std::memory_order_release);
+	}
+
+	size_t			takeDropped() { return _dropped.exchange(0, std::memory_order_relaxed); }
+};
+
+
+// Hierarchical frame profiler
+//  PROFILE_SCOPE("name") times the enclosing block into its thread's ring.
+//  endFrame() drains every ring on the main thread, keeps each scope's time for
+//  the last frame and its average over the last Window frames for the overlay,
+//  and while capturing keeps every event for a Chrome trace (chrome://tracing).
+class Profiler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	static constexpr size_t Window{ 60 };
+
+	struct Stat {
+		std::string		name;
+		std::uint32_t	depth{ 0 };
+		std::uint32_t	calls{ 0 };				// in the last frame
+		double			frameMs{ 0.0 };			// summed over the last frame
+		double			averageMs{ 0.0 };		// per frame, over the last Window frames
+		size_t			order{ 0 };				// where it was first seen in its frame, parents before children
+		std::array<double, Window>	history{};
+		size_t			frames{ 0 };
+	};
+
+private:
+	struct NameHash {
+		using is_transparent = void;
+		size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+	};
+
+	struct TraceEvent {
+		std::string		name;
+		std::uint64_t	start;
+		std::uint64_t	duration;
+		std::uint32_t	thread;
+	};
+
+	Profiler();
+	~Profiler() = default;
+
+	const Clock::time_point			_epoch;
+	const std::thread::id			_mainThread;	// the thread that made the profiler
+	std::mutex						_ringMutex;
+	std::vector<std::unique_ptr<ProfileRing>>	_rings;		// never freed, a thread's ring outlives it
+	std::unordered_set<std::string, NameHash, std::equal_to<>>	_names;
+
+	std::unordered_map<std::string, Stat, NameHash, std::equal_to<>>	_stats;
+	std::vector<ProfileEvent>		_frameEvents;
+	std::vector<TraceEvent>			_trace;
+	bool							_capturing{ false };
+	size_t							_frame{ 0 };
+	size_t							_dropped{ 0 };
+
+	ProfileRing*	registerThread();
+
+public:
+	static Profiler& getInstance();
+
+	// no copy or move
+	Profiler(const Profiler&) = delete;
+	Profiler(Profiler&&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+	Profiler& operator=(Profiler&&) = delete;
+
+	std::uint64_t	now() const {
+		return static_cast<std::uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _epoch).count());
+	}
+
+	// the calling thread's ring, made on its first use
+	ProfileRing&	ring() {
+		thread_local ProfileRing* ring = registerThread();
+		return *ring;
+	}
+
+	// a copy of name that lives as long as the profiler, for scopes named at run time
+	const char*		intern(std::string_view name);
+
+	void			endFrame();
+
+	// every scope in the last frame in call order
+	std::vector<const Stat*>	stats() const;
+	std::string		overlayText() const;
+
+	void			startCapture();
+	bool			isCapturing() const { return _capturing; }
+
+	// stops capturing and writes the events as Chrome trace-event JSON
+	bool			stopCapture(const std::string& path);
+};
+
+
+// times its lifetime into the calling thread's ring
+class ProfileScope
+{
+private:
+	static thread_local std::uint32_t	t_depth;
+
+	const char*		_name;
+	std::uint64_t	_start;
+
+public:
+	explicit ProfileScope(const char* name)
+		: _name(name)
+		, _start(Profiler::getInstance().now()) {
+		++t_depth;
+	}
+
+	~ProfileScope() {
+		auto& profiler = Profiler::getInstance();
+		auto& ring = profiler.ring();
+		--t_depth;
+		ring.push(ProfileEvent{ _name, _start, profiler.now(), t_depth, ring.thread });
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+
+#if EFA_PROFILE
+#define EFA_PROFILE_CONCAT_(a, b) a##b
+#define EFA_PROFILE_CONCAT(a, b) EFA_PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ProfileScope EFA_PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#define PROFILE_END_FRAME() Profiler::getInstance().endFrame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
@@ -0,0 +1,200 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <array>
+
+
+namespace {
+	constexpr int	LayerShift{ 56 };
+	constexpr int	ViewShift{ 48 };
+	constexpr int	DepthShift{ 32 };
+	constexpr int	TextureShift{ 16 };
+	constexpr size_t MaxViews{ 255 };
+	constexpr uint16_t MaxTextureId{ 0xffff };
+}
+
+
+void RenderQueue::setClearColor(sf::Color color)
+{
+	_clearColor = color;
+}
+
+void RenderQueue::setView(const sf::View& view)
+{
+	if (_views.size() == MaxViews)
+		_views.back() = view;
+	else
+		_views.push_back(view);
+	_view = static_cast<uint8_t>(_views.size());
+}
+
+// ids in first seen order, 0 is no texture
+uint16_t RenderQueue::textureId(const sf::Texture* texture)
+{
+	if (!texture)
+		return 0;
+
+	auto found = _textureIds.find(texture);
+	if (found != _textureIds.end())
+		return found->second;
+
+	const uint16_t id = static_cast<uint16_t>(std::min<size_t>(_textureIds.size() + 1, MaxTextureId));
+	_textureIds.emplace(texture, id);
+	return id;
+}
+
+void RenderQueue::push(Kind kind, uint32_t index, int layer, uint16_t depth, const sf::Texture* texture)
+{
+	const uint64_t layerBits = static_cast<uint64_t>(std::clamp(layer, BottomLayer, TopLayer) - BottomLayer);
+	const uint64_t key = (layerBits << LayerShift)
+		| (static_cast<uint64_t>(_view) << ViewShift)
+		| (static_cast<uint64_t>(depth) << DepthShift)
+		| (static_cast<uint64_t>(textureId(texture)) << TextureShift);
+	_commands.push_back(Command{ key, kind, index });
+}
+
+void RenderQueue::draw(const sf::Sprite& sprite, int layer, uint16_t depth)
+{
+	push(Kind::Sprite, _sprites.add(sprite), layer, depth, sprite.getTexture());
+}
+
+void RenderQueue::draw(const CSprite& sprite, const CTransform& tfm, uint16_t depth)
+{
+	const uint32_t index = _sprites.add(sprite.sprite);
+	_sprites.items[index].setPosition(tfm.pos);
+	_sprites.items[index].setRotation(tfm.angle);
+	push(Kind::Sprite, index, sprite.layer, depth, sprite.sprite.getTexture());
+}
+
+void RenderQueue::draw(const sf::Text& text, int layer, uint16_t depth)
+{
+	push(Kind::Text, _texts.add(text), layer, depth, nullptr);
+}
+
+void RenderQueue::draw(const sf::RectangleShape& shape, int layer, uint16_t depth)
+{
+	push(Kind::Rectangle, _rectangles.add(shape), layer, depth, shape.getTexture());
+}
+
+void RenderQueue::draw(const sf::CircleShape& shape, int layer, uint16_t depth)
+{
+	push(Kind::Circle, _circles.add(shape), layer, depth, shape.getTexture());
+}
+
+void RenderQueue::drawReference(const sf::Drawable& drawable, int layer, uint16_t depth)
+{
+	_drawables.push_back(&drawable);
+	push(Kind::Drawable, static_cast<uint32_t>(_drawables.size() - 1), layer, depth, nullptr);
+}
+
+// LSD radix sort on the key a byte at a time, stable, skips bytes every key shares
+void RenderQueue::radixSort()
+{
+	const size_t n = _commands.size();
+	if (n < 2)
+		return;
+
+	std::array<std::array<uint32_t, 256>, 8> counts{};
+	for (const auto& c : _commands)
+		for (int b{ 0 }; b < 8; ++b)
+			counts[b][(c.key >> (b * 8)) & 0xff]++;
+
+	_sorted.resize(n);
+	for (int b{ 0 }; b < 8; ++b) {
+		auto& count = counts[b];
+		if (count[(_commands.front().key >> (b * 8)) & 0xff] == n)
+			continue;
+
+		uint32_t offset{ 0 };
+		for (auto& c : count) {
+			const uint32_t next = offset + c;
+			c = offset;
+			offset = next;
+		}
+
+		for (const auto& c : _commands)
+			_sorted[count[(c.key >> (b * 8)) & 0xff]++] = c;
+		_commands.swap(_sorted);
+	}
+}
+
+void RenderQueue::submit(sf::RenderTarget& target)
+{
+	radixSort();
+
+	if (_clearColor)
+		target.clear(*_clearColor);
+
+	_drawCalls = 0;
+	_viewChanges = 0;
+	const sf::View initialView = target.getView();
+	uint8_t view{ 0 };
+	const sf::Texture* batchTexture{ nullptr };
+	bool batching{ false };
+
+	auto flush = [&]() {
+		if (!batching)
+			return;
+		_batch.draw(target);
+		_drawCalls += _batch.drawCalls();
+		batching = false;
+	};
+
+	for (const auto& c : _commands) {
+		const uint8_t commandView = static_cast<uint8_t>(c.key >> ViewShift);
+		if (commandView != view) {
+			flush();
+			target.setView(commandView ? _views[commandView - 1] : initialView);
+			view = commandView;
+			_viewChanges++;
+		}
+
+		if (c.kind == Kind::Sprite) {
+			const sf::Sprite& sprite = _sprites.items[c.index];
+			if (batching && sprite.getTexture() != batchTexture)
+				flush();
+			_batch.add(sprite);
+			batchTexture = sprite.getTexture();
+			batching = true;
+			continue;
+		}
+
+		flush();
+		switch (c.kind) {
+		case Kind::Text:		target.draw(_texts.items[c.index]); break;
+		case Kind::Rectangle:	target.draw(_rectangles.items[c.index]); break;
+		case Kind::Circle:		target.draw(_circles.items[c.index]); break;
+		case Kind::Drawable:	target.draw(*_drawables[c.index]); break;
+		default: break;
+		}
+		_drawCalls++;
+	}
+	flush();
+
+	// next frame
+	_lastCommands = _commands.size();
+	_commands.clear();
+	_sprites.count = 0;
+	_texts.count = 0;
+	_rectangles.count = 0;
+	_circles.count = 0;
+	_drawables.clear();
+	_views.clear();
+	_view = 0;
+	_textureIds.clear();
+	_clearColor.reset();
+}
+
+size_t RenderQueue::commandCount() const
+{
+	return _lastCommands;
+}
+
+size_t RenderQueue::drawCalls() const
+{
+	return _drawCalls;
+}
+
+size_t RenderQueue::viewChanges() const
+{
+	return _viewChanges;
+}
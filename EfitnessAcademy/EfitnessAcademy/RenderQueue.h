@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Components.h"
+#include "SpriteBatch.h"
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+
+// Sort keyed render queue
+//  scenes submit sprites, texts, shapes and view changes for the frame instead
+//  of drawing them. Each command gets a 64 bit key
+//
+//      | layer 8 | view 8 | depth 16 | texture 16 | unused 16 |
+//
+//  submit() radix sorts the keys and draws in one pass: views are set only
+//  when they change and runs of sprites with one texture go to the GPU as a
+//  single SpriteBatch draw. The sort is stable, commands with equal keys draw
+//  in the order they were submitted, so a frame always draws the same way.
+//  Lower layers draw first, then views in the order they were set, then lower
+//  depths. Sprites, texts and shapes are copied, the pools are kept between
+//  frames so a steady frame does not allocate.
+class RenderQueue
+{
+public:
+	static constexpr int	BottomLayer{ -128 };
+	static constexpr int	TopLayer{ 127 };		// texts and overlays
+
+private:
+	enum class Kind : uint8_t { Sprite, Text, Rectangle, Circle, Drawable };
+
+	struct Command {
+		uint64_t		key;
+		Kind			kind;
+		uint32_t		index;		// into the pool of its kind
+	};
+
+	template<typename T>
+	struct Pool {
+		std::vector<T>	items;
+		size_t			count{ 0 };
+
+		uint32_t		add(const T& item) {
+			if (count < items.size())
+				items[count] = item;		// reuses the copy's buffers
+			else
+				items.push_back(item);
+			return static_cast<uint32_t>(count++);
+		}
+	};
+
+	std::vector<Command>					_commands;
+	std::vector<Command>					_sorted;		// radix sort scratch
+	Pool<sf::Sprite>						_sprites;
+	Pool<sf::Text>							_texts;
+	Pool<sf::RectangleShape>				_rectangles;
+	Pool<sf::CircleShape>					_circles;
+	std::vector<const sf::Drawable*>		_drawables;
+	std::vector<sf::View>					_views;
+	uint8_t									_view{ 0 };		// 0 = the target's view when submit starts
+	std::unordered_map<const sf::Texture*, uint16_t>	_textureIds;
+	std::optional<sf::Color>				_clearColor;
+
+	SpriteBatch								_batch;
+	size_t									_drawCalls{ 0 };
+	size_t									_viewChanges{ 0 };
+	size_t									_lastCommands{ 0 };
+
+	uint16_t		textureId(const sf::Texture* texture);
+	void			push(Kind kind, uint32_t index, int layer, uint16_t depth, const sf::Texture* texture);
+	void			radixSort();
+
+public:
+	// clear the target with this colour before drawing, left as it is when not set
+	void			setClearColor(sf::Color color);
+
+	// commands after this use view, until the next setView
+	void			setView(const sf::View& view);
+
+	void			draw(const sf::Sprite& sprite, int layer = 0, uint16_t depth = 0);
+	void			draw(const CSprite& sprite, const CTransform& tfm, uint16_t depth = 0);
+	void			draw(const sf::Text& text, int layer = 0, uint16_t depth = 0);
+	void			draw(const sf::RectangleShape& shape, int layer = 0, uint16_t depth = 0);
+	void			draw(const sf::CircleShape& shape, int layer = 0, uint16_t depth = 0);
+
+	// anything else, not copied, it must be left alone until submit
+	void			drawReference(const sf::Drawable& drawable, int layer = 0, uint16_t depth = 0);
+
+	// sort, draw everything and start a new frame
+	void			submit(sf::RenderTarget& target);
+
+	size_t			commandCount() const;		// of the last submit
+	size_t			drawCalls() const;
+	size_t			viewChanges() const;
+};
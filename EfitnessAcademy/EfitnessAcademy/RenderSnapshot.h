@@ -0,0 +1,35 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+
+struct SnapshotSprite
+{
+	sf::Sprite		sprite;
+	int				layer{ 0 };
+};
+
+
+// Everything a scene draws in one frame, copied out of the simulation
+//  in pipelined mode the simulation thread fills one while the main thread
+//  draws the previous one. Sprites are drawn first, batched by layer and
+//  texture, rectangles go on layer 0 and text on top.
+//  Textures and fonts are referenced, not copied, they belong to Assets.
+struct RenderSnapshot
+{
+	sf::Color					clearColor{ sf::Color::Cyan };
+	sf::View					view;
+	std::vector<SnapshotSprite>	sprites;
+	std::vector<sf::RectangleShape>	rectangles;
+	std::vector<sf::Text>		texts;
+	size_t						frame{ 0 };
+	size_t						culled{ 0 };		// sprites left out, off screen
+
+	inline void clear() {
+		sprites.clear();
+		rectangles.clear();
+		texts.clear();
+		culled = 0;
+	}
+};
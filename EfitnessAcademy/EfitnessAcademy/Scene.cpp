@@ -1,4 +1,5 @@
 #include "Scene.h"
+#include "Profiler.h"
 
 
 Scene::Scene(GameEngine* gameEngine) : _game(gameEngine)
@@ -13,8 +14,92 @@ void Scene::setPaused(bool paused)
 }
 
 
-void Scene::simulate(int)
-{}
+bool Scene::isIdle() const
+{
+	return false;
+}
+
+void Scene::simulate(size_t frames)
+{
+	for (size_t i{ 0 }; i < frames && !_hasEnded; ++i)
+		update(_game->timeStep());
+}
+
+void Scene::registerExclusiveSystem(const std::string& name, SystemFn fn)
+{
+	_systems.add(name, SystemAccess{ 0, 0, true }, std::move(fn));
+}
+
+void Scene::runSystems(sf::Time dt)
+{
+	_systems.run(_game->jobs(), dt);
+}
+
+void Scene::sMovement(sf::Time dt)
+{
+	PROFILE_FUNCTION();
+	_movement.update(_entityManager, _game->jobs(), dt);
+}
+
+void Scene::sCollision()
+{
+	PROFILE_FUNCTION();
+	_collisions.update(_entityManager, _game->jobs());
+}
+
+void Scene::sCulling()
+{
+	PROFILE_FUNCTION();
+	_culling.update(_entityManager);
+	_cullingFresh = true;
+}
+
+void Scene::cull(const sf::View& view)
+{
+	PROFILE_FUNCTION();
+	if (!_cullingFresh)
+		_culling.update(_entityManager);
+	_cullingFresh = false;
+
+	_visible.clear();
+	_culling.query(view, _visible);
+}
+
+sf::View Scene::camera() const
+{
+	const sf::Vector2f size = _game->windowSize();
+	return sf::View(sf::FloatRect(0.f, 0.f, size.x, size.y));
+}
+
+void Scene::sRenderSprites()
+{
+	PROFILE_FUNCTION();
+	const sf::View view = camera();
+	cull(view);
+
+	auto& queue = _game->renderQueue();
+	queue.setView(view);
+	for (const auto h : _visible) {
+		Entity* e = _entityManager.get(h);
+		queue.draw(e->getComponent<CSprite>(), e->getComponent<CTransform>());
+	}
+	_game->reportCulling(_culling.drawnCount(), _culling.culledCount());
+}
+
+void Scene::sSnapshot(RenderSnapshot& snapshot)
+{
+	snapshot.view = camera();
+	cull(snapshot.view);
+	for (const auto h : _visible) {
+		Entity* e = _entityManager.get(h);
+		const auto& sprite = e->getComponent<CSprite>();
+		const auto& tfm = e->getComponent<CTransform>();
+		auto& copy = snapshot.sprites.emplace_back(SnapshotSprite{ sprite.sprite, sprite.layer });
+		copy.sprite.setPosition(tfm.pos);
+		copy.sprite.setRotation(tfm.angle);
+	}
+	snapshot.culled = _culling.culledCount();
+}
 
 void Scene::doAction(Command command)
 {
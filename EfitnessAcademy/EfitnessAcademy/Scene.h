@@ -3,6 +3,10 @@
 #include "EntityManager.h"
 #include "GameEngine.h"
 #include "Command.h"
+#include "SystemScheduler.h"
+#include "CollisionSystem.h"
+#include "CullingSystem.h"
+#include "MovementSystem.h"
 #include <map>
 #include <string>
 
@@ -22,19 +26,71 @@ protected:
 	bool			_isPaused{ false };
 	bool			_hasEnded{ false };
 	size_t			_currentFrame{ 0 };
+	SystemScheduler	_systems;
+	CollisionSystem	_collisions;
+	MovementSystem	_movement;
+	CullingSystem	_culling;
+	bool			_cullingFresh{ false };		// rebuilt by sCulling since the last draw
+	std::vector<EntityHandle>	_visible;
 
 	virtual void	onEnd() = 0;
 	void			setPaused(bool paused);
 
+	// Systems
+	//  registered in the order they should run, each declares the components it
+	//  reads and writes so non-conflicting systems can run in parallel. Those
+	//  must not add entities or add or remove components directly. Destroy and
+	//  the EntityManager's deferred calls are safe from them, they are recorded
+	//  under a lock and applied by EntityManager::update, anything else needs
+	//  an exclusive system
+	template<typename... R, typename... W>
+	void			registerSystem(const std::string& name, Reads<R...>, Writes<W...>, SystemFn fn) {
+		_systems.add(name, SystemAccess{ signatureOf<R...>, signatureOf<W...>, false }, std::move(fn));
+	}
+	void			registerExclusiveSystem(const std::string& name, SystemFn fn);
+	void			runSystems(sf::Time dt);
+
+	// integrate every CTransform's velocity and angular velocity
+	void			sMovement(sf::Time dt);
+
+	// the view sprites are culled against and drawn with, by sRenderSprites and
+	// by sSnapshot in pipelined mode. The default shows the window at the origin,
+	// a scrolling scene returns its camera
+	virtual sf::View	camera() const;
+
+	// queue every CSprite at its CTransform that is inside camera(), which the
+	// render queue draws them with. The queue batches them by layer and texture
+	void			sRenderSprites();
+
+	// find this frame's contacts, call after movement, read them from _collisions.contacts()
+	void			sCollision();
+
+	// rebuild the culling grid, call last in update so drawing only queries it.
+	//  Scenes that do not call it have the grid rebuilt when they draw
+	void			sCulling();
+
+	// the CSprite entities inside the view into _visible
+	void			cull(const sf::View& view);
+
 public:
 	Scene(GameEngine* gameEngine);
 	virtual ~Scene();
 
 	virtual void		update(sf::Time dt) = 0;
 	virtual void		sDoAction(const Command& action) = 0;
+	// submit the frame to _game->renderQueue(), the engine draws it when sRender returns
 	virtual void		sRender() = 0;
 
-	void				simulate(int);
+	// true when nothing on screen changes without input, the engine then only
+	// redraws after an event
+	virtual bool		isIdle() const;
+
+	// copy what sRender would draw, called on the simulation thread in pipelined
+	// mode. The default copies every CSprite inside camera() placed at its CTransform
+	virtual void		sSnapshot(RenderSnapshot& snapshot);
+
+	// run update() frames times back to back, stops early if the scene ends
+	void				simulate(size_t frames);
 	void				doAction(Command);
 	void				registerAction(int, std::string);
 	const CommandMap	getActionMap() const;
@@ -5,6 +5,11 @@
 #include <string>
 #include <cmath>
 #include <random>
+#include <algorithm>
+#include "TextCache.h"
+#include "FramePacer.h"
+#include "RenderQueue.h"
+#include "ParticleSystem.h"
 
 class SevenPillarsGame {
 private:
@@ -12,7 +17,7 @@ private:
     sf::Font font;
     sf::Text titleText, instructionText, buttonText;
     sf::RectangleShape background, pillarBase, glowEffect;
-    sf::CircleShape breathCircle, pillarGlow;
+    sf::CircleShape breathCircle;
 
     enum GameState {
         WELCOME,
@@ -73,6 +78,34 @@ private:
         "\"Every experience teaches me something valuable\""
     };
 
+    // Retained text
+    //  the numbered labels are built once, progressLabel only when a pillar
+    //  changes. Everything is drawn through textCache, so a frame builds no
+    //  strings and no glyph geometry
+    TextCache textCache;
+    std::vector<std::string> pillarLabels;
+    std::vector<std::string> emotionalLabels;
+    std::vector<std::string> purposeLabels;
+    std::vector<std::string> financialLabels;
+    std::vector<std::string> mentalLabels;
+    std::string progressLabel;
+
+    // everything a frame draws, in submission order, drawn by render()
+    RenderQueue queue;
+
+    // Effects
+    //  the pillar glows, the breath ring and the spiritual aura are particle
+    //  emitters, switched on for the screen they belong to
+    ParticleSystem particles{ 8192 };
+    std::vector<EmitterId> pillarEmitters;
+    EmitterId breathEmitter{ 0 };
+    EmitterId auraEmitter{ 0 };
+    GameState effectsState{ WELCOME };
+
+    // Frame pacing, static screens are only redrawn after an event
+    FramePacer pacer{ 60 };
+    const sf::Time idleTimeout = sf::milliseconds(250);
+
 public:
     SevenPillarsGame() : window(sf::VideoMode(1200, 800), "The 7 Pillars of Self"),
         currentState(WELCOME),
@@ -98,10 +131,41 @@ public:
             "Mental", "Environmental", "Spiritual"
         };
 
+        pillarLabels = numbered(pillarNames);
+        emotionalLabels = numbered(emotionalOptions);
+        purposeLabels = numbered(purposeQuotes);
+        financialLabels = numbered(financialOptions);
+        mentalLabels = numbered(mentalOptions);
+        updateProgressLabel();
+
         // Setup basic shapes and text
         setupGraphics();
     }
 
+    static std::vector<std::string> numbered(const std::vector<std::string>& items) {
+        std::vector<std::string> labels;
+        for (size_t i = 0; i < items.size(); i++) {
+            labels.push_back(std::to_string(i + 1) + ". " + items[i]);
+        }
+        return labels;
+    }
+
+    void updateProgressLabel() {
+        int completed = 0;
+        for (bool activated : pillarsActivated) {
+            if (activated) completed++;
+        }
+        progressLabel = "Progress: " + std::to_string(completed) + "/7 pillars activated";
+    }
+
+    // style is a prototype for font, size and colour, it is never drawn itself
+    void drawText(const sf::Text& style, std::string_view string, float x, float y, unsigned int size = 0) {
+        sf::Text& text = textCache.get(*style.getFont(), size ? size : style.getCharacterSize(), string, style.getStyle());
+        text.setFillColor(style.getFillColor());
+        text.setPosition(x, y);
+        queue.draw(text);
+    }
+
     void setupGraphics() {
         // Create a simple font (you would load a real font file)
         // For this example, we'll use the default font
@@ -140,33 +204,143 @@ public:
         breathCircle.setFillColor(sf::Color(100, 150, 255, 100));
         breathCircle.setPosition(550, 350);
 
-        // Setup pillar glow
-        pillarGlow.setRadius(60);
-        pillarGlow.setFillColor(sf::Color(255, 255, 255, 100));
+        setupEffects();
+    }
+
+    // top left of pillar i on the main menu
+    static sf::Vector2f pillarPosition(int i) {
+        float angle = (i * 2 * M_PI) / 7 - M_PI / 2;
+        return sf::Vector2f(600 + 200 * cos(angle) - 50, 400 + 200 * sin(angle) - 75);
+    }
+
+    void setupEffects() {
+        for (int i = 0; i < 7; i++) {
+            EmitterDesc glow;
+            glow.position = pillarPosition(i) + sf::Vector2f(50, 75);
+            glow.spawnRadius = 55;
+            glow.rate = 60;
+            glow.lifeMin = 0.8f; glow.lifeMax = 1.6f;
+            glow.speedMin = 5; glow.speedMax = 20;
+            glow.radial = true;
+            glow.angleMin = -30; glow.angleMax = 30;
+            glow.sizeStart = 22; glow.sizeEnd = 4;
+            glow.colorStart = pillarColors[i];
+            glow.colorEnd = sf::Color(pillarColors[i].r, pillarColors[i].g, pillarColors[i].b, 0);
+            pillarEmitters.push_back(particles.addEmitter(glow));
+            particles.setActive(pillarEmitters.back(), false);
+        }
+
+        EmitterDesc breath;
+        breath.position = breathCircle.getPosition();
+        breath.rate = 120;
+        breath.lifeMin = 0.6f; breath.lifeMax = 1.2f;
+        breath.speedMin = 10; breath.speedMax = 25;
+        breath.radial = true;
+        breath.angleMin = -20; breath.angleMax = 20;
+        breath.sizeStart = 12; breath.sizeEnd = 2;
+        breath.colorStart = sf::Color(100, 150, 255, 160);
+        breath.colorEnd = sf::Color(100, 150, 255, 0);
+        breathEmitter = particles.addEmitter(breath);
+        particles.setActive(breathEmitter, false);
+
+        EmitterDesc aura;
+        aura.position = sf::Vector2f(600, 440);
+        aura.spawnRadius = 110;
+        aura.rate = 150;
+        aura.lifeMin = 1.0f; aura.lifeMax = 2.0f;
+        aura.speedMin = 5; aura.speedMax = 15;
+        aura.radial = true;
+        aura.angleMin = -90; aura.angleMax = 90;
+        aura.acceleration = sf::Vector2f(0, -10);
+        aura.sizeStart = 26; aura.sizeEnd = 8;
+        aura.colorEnd = sf::Color(255, 255, 255, 0);
+        auraEmitter = particles.addEmitter(aura);
+        particles.setActive(auraEmitter, false);
+    }
+
+    // emitters follow the screen and the breath and glow animations
+    void updateEffects(float deltaTime) {
+        if (effectsState != currentState) {
+            particles.clear();
+            effectsState = currentState;
+        }
+
+        const sf::Uint8 glow = static_cast<sf::Uint8>(glowAlpha);
+        for (int i = 0; i < 7; i++) {
+            particles.setActive(pillarEmitters[i], currentState == MAIN_MENU && pillarsActivated[i]);
+            particles.emitter(pillarEmitters[i]).colorStart.a = glow;
+        }
+
+        particles.setActive(breathEmitter, currentState == PHYSICAL);
+        particles.emitter(breathEmitter).spawnRadius = breathSize;
+
+        particles.setActive(auraEmitter, currentState == SPIRITUAL);
+        particles.emitter(auraEmitter).colorStart = sf::Color(255, 255, 255, glow / 2);
+
+        particles.update(deltaTime);
     }
 
     void run() {
+        bool redraw = true;
         while (window.isOpen()) {
-            handleEvents();
+            redraw |= handleEvents();
             update();
-            render();
+
+            if (redraw || isAnimating()) {
+                render();
+                redraw = false;
+                pacer.wait();
+            }
+            else {
+                // nothing is moving, sleep until the next event
+                sf::Event event;
+                if (waitEvent(window, event, idleTimeout)) {
+                    handleEvent(event);
+                    redraw = true;
+                }
+                animationClock.restart();
+                pacer.reset();
+            }
+        }
+    }
+
+    // the breath circle and the pillar glows are the only things that move on their own
+    bool isAnimating() const {
+        if (particles.liveCount() > 0)
+            return true;
+
+        switch (currentState) {
+        case PHYSICAL:
+        case SPIRITUAL:
+            return true;
+        case MAIN_MENU:
+            return std::find(pillarsActivated.begin(), pillarsActivated.end(), true) != pillarsActivated.end();
+        default:
+            return false;
         }
     }
 
-    void handleEvents() {
+    bool handleEvents() {
+        bool any = false;
         sf::Event event;
         while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
-            }
+            handleEvent(event);
+            any = true;
+        }
+        return any;
+    }
 
-            if (event.type == sf::Event::KeyPressed) {
-                handleKeyPress(event.key.code);
-            }
+    void handleEvent(const sf::Event& event) {
+        if (event.type == sf::Event::Closed) {
+            window.close();
+        }
 
-            if (event.type == sf::Event::MouseButtonPressed) {
-                handleMouseClick(event.mouseButton.x, event.mouseButton.y);
-            }
+        if (event.type == sf::Event::KeyPressed) {
+            handleKeyPress(event.key.code);
+        }
+
+        if (event.type == sf::Event::MouseButtonPressed) {
+            handleMouseClick(event.mouseButton.x, event.mouseButton.y);
         }
     }
 
@@ -255,6 +429,7 @@ public:
         // Update animations
         updateBreathAnimation(deltaTime);
         updateGlowAnimation(deltaTime);
+        updateEffects(deltaTime);
 
         // Check if all pillars are completed
         bool allCompleted = true;
@@ -300,12 +475,14 @@ public:
         int pillarIndex = currentState - EMOTIONAL;
         if (pillarIndex >= 0 && pillarIndex < 7) {
             pillarsActivated[pillarIndex] = true;
+            updateProgressLabel();
         }
         currentState = MAIN_MENU;
     }
 
     void resetGame() {
         std::fill(pillarsActivated.begin(), pillarsActivated.end(), false);
+        updateProgressLabel();
         currentState = MAIN_MENU;
         selectedOption = -1;
         optionSelected = false;
@@ -313,8 +490,11 @@ public:
     }
 
     void render() {
-        window.clear();
-        window.draw(background);
+        queue.setClearColor(sf::Color::Black);
+        queue.draw(background, RenderQueue::BottomLayer);
+
+        // glows behind the pillars, the aura over the silhouette
+        queue.drawReference(particles, currentState == MAIN_MENU ? -1 : 1);
 
         switch (currentState) {
         case WELCOME:
@@ -349,337 +529,187 @@ public:
             break;
         }
 
+        queue.submit(window);
         window.display();
     }
 
     void renderWelcomeScreen() {
-        titleText.setString("The 7 Pillars of Self");
-        titleText.setPosition(250, 200);
-        window.draw(titleText);
-
-        instructionText.setString("A Journey of Self-Discovery and Growth");
-        instructionText.setPosition(350, 300);
-        window.draw(instructionText);
-
-        instructionText.setString("Based on Indigenous Wisdom and Emotional Fitness");
-        instructionText.setPosition(280, 350);
-        window.draw(instructionText);
-
-        instructionText.setString("Press ENTER to begin your journey");
-        instructionText.setPosition(400, 450);
-        window.draw(instructionText);
-
-        instructionText.setString("Emotional Fitness Academy");
-        instructionText.setCharacterSize(18);
-        instructionText.setPosition(500, 650);
-        window.draw(instructionText);
-        instructionText.setCharacterSize(24);
+        drawText(titleText, "The 7 Pillars of Self", 250, 200);
+        drawText(instructionText, "A Journey of Self-Discovery and Growth", 350, 300);
+        drawText(instructionText, "Based on Indigenous Wisdom and Emotional Fitness", 280, 350);
+        drawText(instructionText, "Press ENTER to begin your journey", 400, 450);
+        drawText(instructionText, "Emotional Fitness Academy", 500, 650, 18);
     }
 
     void renderMainMenu() {
-        titleText.setString("Choose a Pillar to Explore");
-        titleText.setPosition(300, 100);
-        window.draw(titleText);
+        drawText(titleText, "Choose a Pillar to Explore", 300, 100);
 
         // Draw pillars in a circle
-        float centerX = 600;
-        float centerY = 400;
-        float radius = 200;
-
         for (int i = 0; i < 7; i++) {
-            float angle = (i * 2 * M_PI) / 7 - M_PI / 2;
-            float x = centerX + radius * cos(angle) - 50;
-            float y = centerY + radius * sin(angle) - 75;
+            const sf::Vector2f position = pillarPosition(i);
+            float x = position.x;
+            float y = position.y;
 
-            // Draw pillar base
+            // Draw pillar base, an activated one glows through its emitter
             pillarBase.setPosition(x, y);
             if (pillarsActivated[i]) {
                 pillarBase.setFillColor(pillarColors[i]);
-                // Draw glow effect
-                sf::Color glowColor = pillarColors[i];
-                glowColor.a = static_cast<sf::Uint8>(glowAlpha);
-                pillarGlow.setFillColor(glowColor);
-                pillarGlow.setPosition(x - 10, y - 10);
-                window.draw(pillarGlow);
             }
             else {
                 pillarBase.setFillColor(sf::Color(100, 100, 100));
             }
-            window.draw(pillarBase);
+            queue.draw(pillarBase);
 
             // Draw pillar name
-            buttonText.setString(std::to_string(i + 1) + ". " + pillarNames[i]);
-            buttonText.setPosition(x - 20, y + 160);
-            window.draw(buttonText);
+            drawText(buttonText, pillarLabels[i], x - 20, y + 160);
         }
 
-        instructionText.setString("Press 1-7 to explore each pillar");
-        instructionText.setPosition(450, 650);
-        window.draw(instructionText);
+        drawText(instructionText, "Press 1-7 to explore each pillar", 450, 650);
 
         // Show progress
-        int completed = 0;
-        for (bool activated : pillarsActivated) {
-            if (activated) completed++;
-        }
-        instructionText.setString("Progress: " + std::to_string(completed) + "/7 pillars activated");
-        instructionText.setPosition(450, 700);
-        window.draw(instructionText);
+        drawText(instructionText, progressLabel, 450, 700);
     }
 
     void renderEmotionalPillar() {
-        titleText.setString("Emotional Pillar");
-        titleText.setPosition(450, 100);
-        window.draw(titleText);
-
-        instructionText.setString("How do you feel today and what do you want to do with that emotion?");
-        instructionText.setPosition(200, 200);
-        window.draw(instructionText);
+        drawText(titleText, "Emotional Pillar", 450, 100);
+        drawText(instructionText, "How do you feel today and what do you want to do with that emotion?", 200, 200);
 
         for (int i = 0; i < emotionalOptions.size(); i++) {
             sf::Color textColor = (selectedOption == i) ? sf::Color::Yellow : sf::Color::White;
             buttonText.setFillColor(textColor);
-            buttonText.setString(std::to_string(i + 1) + ". " + emotionalOptions[i]);
-            buttonText.setPosition(150, 280 + i * 40);
-            window.draw(buttonText);
+            drawText(buttonText, emotionalLabels[i], 150, 280 + i * 40);
         }
         buttonText.setFillColor(sf::Color::White);
 
         if (optionSelected) {
-            instructionText.setString("Press ENTER to activate the Emotional Pillar");
-            instructionText.setPosition(400, 600);
-            window.draw(instructionText);
+            drawText(instructionText, "Press ENTER to activate the Emotional Pillar", 400, 600);
         }
 
-        instructionText.setString("Press ESC to return to main menu");
-        instructionText.setPosition(450, 700);
-        window.draw(instructionText);
+        drawText(instructionText, "Press ESC to return to main menu", 450, 700);
     }
 
     void renderPurposePillar() {
-        titleText.setString("Purpose Pillar");
-        titleText.setPosition(450, 100);
-        window.draw(titleText);
-
-        instructionText.setString("Which quote inspires you the most?");
-        instructionText.setPosition(400, 200);
-        window.draw(instructionText);
+        drawText(titleText, "Purpose Pillar", 450, 100);
+        drawText(instructionText, "Which quote inspires you the most?", 400, 200);
 
         for (int i = 0; i < purposeQuotes.size(); i++) {
             sf::Color textColor = (selectedOption == i) ? sf::Color::Yellow : sf::Color::White;
             buttonText.setFillColor(textColor);
-            buttonText.setString(std::to_string(i + 1) + ". " + purposeQuotes[i]);
-            buttonText.setPosition(100, 280 + i * 50);
-            window.draw(buttonText);
+            drawText(buttonText, purposeLabels[i], 100, 280 + i * 50);
         }
         buttonText.setFillColor(sf::Color::White);
 
         if (optionSelected) {
-            instructionText.setString("Press ENTER to activate the Purpose Pillar");
-            instructionText.setPosition(400, 600);
-            window.draw(instructionText);
+            drawText(instructionText, "Press ENTER to activate the Purpose Pillar", 400, 600);
         }
 
-        instructionText.setString("Press ESC to return to main menu");
-        instructionText.setPosition(450, 700);
-        window.draw(instructionText);
+        drawText(instructionText, "Press ESC to return to main menu", 450, 700);
     }
 
     void renderFinancialPillar() {
-        titleText.setString("Financial Pillar");
-        titleText.setPosition(450, 100);
-        window.draw(titleText);
-
-        instructionText.setString("Choose a wise financial action:");
-        instructionText.setPosition(400, 200);
-        window.draw(instructionText);
+        drawText(titleText, "Financial Pillar", 450, 100);
+        drawText(instructionText, "Choose a wise financial action:", 400, 200);
 
         for (int i = 0; i < financialOptions.size(); i++) {
             sf::Color textColor = (selectedOption == i) ? sf::Color::Yellow : sf::Color::White;
             buttonText.setFillColor(textColor);
-            buttonText.setString(std::to_string(i + 1) + ". " + financialOptions[i]);
-            buttonText.setPosition(350, 280 + i * 40);
-            window.draw(buttonText);
+            drawText(buttonText, financialLabels[i], 350, 280 + i * 40);
         }
         buttonText.setFillColor(sf::Color::White);
 
         if (optionSelected) {
-            instructionText.setString("Press ENTER to activate the Financial Pillar");
-            instructionText.setPosition(400, 600);
-            window.draw(instructionText);
+            drawText(instructionText, "Press ENTER to activate the Financial Pillar", 400, 600);
         }
 
-        instructionText.setString("Press ESC to return to main menu");
-        instructionText.setPosition(450, 700);
-        window.draw(instructionText);
+        drawText(instructionText, "Press ESC to return to main menu", 450, 700);
     }
 
     void renderPhysicalPillar() {
-        titleText.setString("Physical Pillar");
-        titleText.setPosition(450, 100);
-        window.draw(titleText);
-
-        instructionText.setString("Follow the guided breathing exercise");
-        instructionText.setPosition(400, 200);
-        window.draw(instructionText);
-
-        instructionText.setString("Watch the circle expand and contract");
-        instructionText.setPosition(400, 250);
-        window.draw(instructionText);
-
-        instructionText.setString("Breathe in as it grows, breathe out as it shrinks");
-        instructionText.setPosition(350, 300);
-        window.draw(instructionText);
+        drawText(titleText, "Physical Pillar", 450, 100);
+        drawText(instructionText, "Follow the guided breathing exercise", 400, 200);
+        drawText(instructionText, "Watch the circle expand and contract", 400, 250);
+        drawText(instructionText, "Breathe in as it grows, breathe out as it shrinks", 350, 300);
 
         // Draw animated breathing circle
-        window.draw(breathCircle);
-
-        instructionText.setString("Press SPACE when you feel centered");
-        instructionText.setPosition(400, 600);
-        window.draw(instructionText);
+        queue.draw(breathCircle);
 
-        instructionText.setString("Press ESC to return to main menu");
-        instructionText.setPosition(450, 700);
-        window.draw(instructionText);
+        drawText(instructionText, "Press SPACE when you feel centered", 400, 600);
+        drawText(instructionText, "Press ESC to return to main menu", 450, 700);
     }
 
     void renderMentalPillar() {
-        titleText.setString("Mental Pillar");
-        titleText.setPosition(450, 100);
-        window.draw(titleText);
-
-        instructionText.setString("Choose the most helpful thought:");
-        instructionText.setPosition(400, 200);
-        window.draw(instructionText);
+        drawText(titleText, "Mental Pillar", 450, 100);
+        drawText(instructionText, "Choose the most helpful thought:", 400, 200);
 
         for (int i = 0; i < mentalOptions.size(); i++) {
             sf::Color textColor = (selectedOption == i) ? sf::Color::Yellow : sf::Color::White;
             buttonText.setFillColor(textColor);
-            buttonText.setString(std::to_string(i + 1) + ". " + mentalOptions[i]);
-            buttonText.setPosition(100, 280 + i * 50);
-            window.draw(buttonText);
+            drawText(buttonText, mentalLabels[i], 100, 280 + i * 50);
         }
         buttonText.setFillColor(sf::Color::White);
 
         if (optionSelected) {
-            instructionText.setString("Press ENTER to activate the Mental Pillar");
-            instructionText.setPosition(400, 600);
-            window.draw(instructionText);
+            drawText(instructionText, "Press ENTER to activate the Mental Pillar", 400, 600);
         }
 
-        instructionText.setString("Press ESC to return to main menu");
-        instructionText.setPosition(450, 700);
-        window.draw(instructionText);
+        drawText(instructionText, "Press ESC to return to main menu", 450, 700);
     }
 
     void renderEnvironmentalPillar() {
-        titleText.setString("Environmental Pillar");
-        titleText.setPosition(450, 100);
-        window.draw(titleText);
-
-        instructionText.setString("Plant a tree to connect with Mother Earth");
-        instructionText.setPosition(400, 200);
-        window.draw(instructionText);
+        drawText(titleText, "Environmental Pillar", 450, 100);
+        drawText(instructionText, "Plant a tree to connect with Mother Earth", 400, 200);
 
         // Draw growing tree
         sf::RectangleShape trunk(sf::Vector2f(20, 100 * treeGrowth));
         trunk.setFillColor(sf::Color(101, 67, 33));
         trunk.setPosition(590, 500 - 100 * treeGrowth);
-        window.draw(trunk);
+        queue.draw(trunk);
 
         if (treeGrowth > 0.3f) {
             sf::CircleShape leaves(30 * treeGrowth);
             leaves.setFillColor(sf::Color(34, 139, 34));
             leaves.setPosition(570, 420 - 80 * treeGrowth);
-            window.draw(leaves);
+            queue.draw(leaves);
         }
 
-        instructionText.setString("Click on the tree area or press SPACE to help it grow");
-        instructionText.setPosition(350, 550);
-        window.draw(instructionText);
+        drawText(instructionText, "Click on the tree area or press SPACE to help it grow", 350, 550);
 
         if (treeGrowth >= 1.0f) {
-            instructionText.setString("Beautiful! The Environmental Pillar is activated!");
-            instructionText.setPosition(350, 600);
-            window.draw(instructionText);
+            drawText(instructionText, "Beautiful! The Environmental Pillar is activated!", 350, 600);
         }
 
-        instructionText.setString("Press ESC to return to main menu");
-        instructionText.setPosition(450, 700);
-        window.draw(instructionText);
+        drawText(instructionText, "Press ESC to return to main menu", 450, 700);
     }
 
     void renderSpiritualPillar() {
-        titleText.setString("Spiritual Pillar");
-        titleText.setPosition(450, 100);
-        window.draw(titleText);
-
-        instructionText.setString("Take a moment for quiet reflection");
-        instructionText.setPosition(400, 200);
-        window.draw(instructionText);
-
-        instructionText.setString("Listen to the silence within");
-        instructionText.setPosition(400, 250);
-        window.draw(instructionText);
+        drawText(titleText, "Spiritual Pillar", 450, 100);
+        drawText(instructionText, "Take a moment for quiet reflection", 400, 200);
+        drawText(instructionText, "Listen to the silence within", 400, 250);
 
         // Draw meditation silhouette
         sf::CircleShape head(40);
         head.setFillColor(sf::Color(50, 50, 50));
         head.setPosition(560, 350);
-        window.draw(head);
+        queue.draw(head);
 
         sf::RectangleShape body(sf::Vector2f(80, 100));
         body.setFillColor(sf::Color(50, 50, 50));
         body.setPosition(560, 430);
-        window.draw(body);
-
-        // Draw aura
-        sf::CircleShape aura(120);
-        aura.setFillColor(sf::Color(255, 255, 255, static_cast<sf::Uint8>(glowAlpha / 3)));
-        aura.setPosition(480, 320);
-        window.draw(aura);
-
-        instructionText.setString("Press SPACE when you feel a sense of calm");
-        instructionText.setPosition(400, 600);
-        window.draw(instructionText);
+        queue.draw(body);
 
-        instructionText.setString("Press ESC to return to main menu");
-        instructionText.setPosition(450, 700);
-        window.draw(instructionText);
+        drawText(instructionText, "Press SPACE when you feel a sense of calm", 400, 600);
+        drawText(instructionText, "Press ESC to return to main menu", 450, 700);
     }
 
     void renderCompletionScreen() {
-        titleText.setString("Congratulations!");
-        titleText.setPosition(400, 150);
-        window.draw(titleText);
-
-        instructionText.setString("You have activated all 7 Pillars of Self!");
-        instructionText.setPosition(350, 250);
-        window.draw(instructionText);
-
-        instructionText.setString("Your foundation is now strong and balanced.");
-        instructionText.setPosition(350, 300);
-        window.draw(instructionText);
-
-        instructionText.setString("Remember: True transformation comes from within.");
-        instructionText.setPosition(320, 350);
-        window.draw(instructionText);
-
-        instructionText.setString("Your innate wisdom is your greatest tool.");
-        instructionText.setPosition(350, 400);
-        window.draw(instructionText);
-
-        instructionText.setString("Continue your journey with the Emotional Fitness Academy");
-        instructionText.setPosition(250, 500);
-        window.draw(instructionText);
-
-        instructionText.setString("Visit: https://efitacademy.ca/");
-        instructionText.setPosition(450, 550);
-        window.draw(instructionText);
-
-        instructionText.setString("Press ENTER to start a new journey");
-        instructionText.setPosition(400, 650);
-        window.draw(instructionText);
+        drawText(titleText, "Congratulations!", 400, 150);
+        drawText(instructionText, "You have activated all 7 Pillars of Self!", 350, 250);
+        drawText(instructionText, "Your foundation is now strong and balanced.", 350, 300);
+        drawText(instructionText, "Remember: True transformation comes from within.", 320, 350);
+        drawText(instructionText, "Your innate wisdom is your greatest tool.", 350, 400);
+        drawText(instructionText, "Continue your journey with the Emotional Fitness Academy", 250, 500);
+        drawText(instructionText, "Visit: https://efitacademy.ca/", 450, 550);
+        drawText(instructionText, "Press ENTER to start a new journey", 400, 650);
     }
 };
 
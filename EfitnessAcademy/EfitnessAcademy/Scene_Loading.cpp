@@ -0,0 +1,71 @@
+#include "Scene_Loading.h"
+#include "Scene_Menu.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <memory>
+
+void Scene_Loading::onEnd()
+{
+	_game->quit();
+}
+
+Scene_Loading::Scene_Loading(GameEngine* gameEngine)
+	: Scene(gameEngine)
+{
+	registerAction(sf::Keyboard::Escape, "QUIT");
+}
+
+void Scene_Loading::update(sf::Time dt)
+{
+	PROFILE_FUNCTION();
+	const float progress = Assets::getInstance().loadingProgress();
+	m_shown = std::min(progress, m_shown + (progress - m_shown) * std::min(1.f, dt.asSeconds() * 10.f) + 0.001f);
+
+	// the menu needs the fonts, it is only made once loading is over. Ending
+	// here stops simulate() from stepping this scene again in the same frame
+	if (!Assets::getInstance().isLoading()) {
+		_hasEnded = true;
+		_game->changeScene("MENU", std::make_shared<Scene_Menu>(_game), true);
+	}
+}
+
+
+void Scene_Loading::sRender()
+{
+	PROFILE_FUNCTION();
+	m_frame.clear();
+	sSnapshot(m_frame);
+	_game->drawSnapshot(m_frame);
+}
+
+
+void Scene_Loading::sSnapshot(RenderSnapshot& snapshot)
+{
+	static const sf::Color backgroundColor(84, 146, 163);
+	static const sf::Color trackColor(40, 70, 80);
+	static const sf::Color barColor(240, 240, 240);
+
+	snapshot.clearColor = backgroundColor;
+
+	const sf::Vector2f size = _game->windowSize();
+	snapshot.view = sf::View(sf::FloatRect(0.f, 0.f, size.x, size.y));
+
+	const sf::Vector2f track(size.x * 0.5f, 24.f);
+	const sf::Vector2f topLeft((size.x - track.x) / 2.f, (size.y - track.y) / 2.f);
+
+	sf::RectangleShape shape(track);
+	shape.setPosition(topLeft);
+	shape.setFillColor(trackColor);
+	snapshot.rectangles.push_back(shape);
+
+	shape.setSize(sf::Vector2f(track.x * m_shown, track.y));
+	shape.setFillColor(barColor);
+	snapshot.rectangles.push_back(shape);
+}
+
+
+void Scene_Loading::sDoAction(const Command& action)
+{
+	if (action.type() == "START" && action.name() == "QUIT")
+		onEnd();
+}
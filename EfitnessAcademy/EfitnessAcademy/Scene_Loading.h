@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Scene.h"
+
+// Shown while Assets loads in the background
+//  draws a progress bar and moves on to the menu once everything is loaded.
+//  Fonts may still be loading, so it draws shapes only
+class Scene_Loading : public Scene
+{
+private:
+	RenderSnapshot				m_frame;
+	float						m_shown{ 0.f };		// eases towards the real progress
+
+	void onEnd() override;
+public:
+
+	Scene_Loading(GameEngine* gameEngine);
+
+	void update(sf::Time dt) override;
+
+	void sRender() override;
+	void sSnapshot(RenderSnapshot& snapshot) override;
+	void sDoAction(const Command& action) override;
+};
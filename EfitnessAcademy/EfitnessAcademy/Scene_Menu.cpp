@@ -1,11 +1,12 @@
 #include "Scene_Menu.h"
 //#include "Scene_Frogger.h"
 #include "MusicPlayer.h"
+#include "Profiler.h"
 #include <memory>
 
 void Scene_Menu::onEnd()
 {
-	_game->window().close();
+	_game->quit();
 }
 
 Scene_Menu::Scene_Menu(GameEngine* gameEngine)
@@ -33,7 +34,7 @@ void Scene_Menu::init()
 
 	m_levelPaths.push_back("../level1.txt");
 
-	m_menuText.setFont(Assets::getInstance().getFont("Arcade"));
+	m_menuText.setFont(Assets::getInstance().getFont("Arcade"_asset));
 
 	const size_t CHAR_SIZE{ 84 };
 	m_menuText.setCharacterSize(CHAR_SIZE);
@@ -42,19 +43,35 @@ void Scene_Menu::init()
 
 void Scene_Menu::update(sf::Time dt)
 {
+	PROFILE_FUNCTION();
 	_entityManager.update();
 }
 
 
 void Scene_Menu::sRender()
+{
+	PROFILE_FUNCTION();
+	m_frame.clear();
+	sSnapshot(m_frame);
+	_game->drawSnapshot(m_frame);
+}
+
+
+// the menu only changes on input
+bool Scene_Menu::isIdle() const
+{
+	return true;
+}
+
+
+void Scene_Menu::sSnapshot(RenderSnapshot& snapshot)
 {
 	static const sf::Color backgroundColor(84, 146, 163);
 
-	_game->window().clear(sf::Color(backgroundColor));
+	snapshot.clearColor = backgroundColor;
 
-	sf::View view = _game->window().getView();
-	view.setCenter(_game->window().getSize().x / 2.f, _game->window().getSize().y / 2.f);
-	_game->window().setView(view);
+	const sf::Vector2f size = _game->windowSize();
+	snapshot.view = sf::View(sf::FloatRect(0.f, 0.f, size.x, size.y));
 
 	//static const sf::Color selectedColor(255, 255, 255);
 	static const sf::Color normalColor(0, 0, 0);
@@ -69,17 +86,17 @@ void Scene_Menu::sRender()
 	m_menuText.setFillColor(normalColor);
 	m_menuText.setString(m_title);
 	m_menuText.setPosition(475, 10);
-	_game->window().draw(m_menuText);
+	snapshot.texts.push_back(m_menuText);
 
 	for (size_t i{ 0 }; i < m_menuStrings.size(); ++i)
 	{
 		//m_menuText.setFillColor((i == m_menuIndex ? selectedColor : normalColor));
 		m_menuText.setPosition(32, 32 + (i + 1) * 96);
 		m_menuText.setString(m_menuStrings.at(i));
-		_game->window().draw(m_menuText);
+		snapshot.texts.push_back(m_menuText);
 	}
 
-	//_game->window().draw(footer);
+	//snapshot.texts.push_back(footer);
 
 }
 
@@ -10,6 +10,7 @@ private:
 	std::vector<std::string>	m_levelPaths;
 	int							m_menuIndex{ 0 };
 	std::string					m_title;
+	RenderSnapshot				m_frame;
 
 
 	void init();
@@ -21,6 +22,8 @@ public:
 	void update(sf::Time dt) override;
 
 	void sRender() override;
+	void sSnapshot(RenderSnapshot& snapshot) override;
+	bool isIdle() const override;
 	void sDoAction(const Command& action) override;
 
 
@@ -6,12 +6,30 @@
 
 
 #include <iostream>
+#include <cstdlib>
+#include <string>
 #include "GameEngine.h"
 
 
 
-int main()
+int main(int argc, char* argv[])
 {
+    // --headless N steps the game N frames without a window and reports the rate
+    if (argc > 1 && std::string(argv[1]) == "--headless")
+    {
+        char* end{ nullptr };
+        const unsigned long long frames = argc > 2 ? std::strtoull(argv[2], &end, 10) : 0;
+        if (argc < 3 || end == argv[2] || *end != '\0' || argv[2][0] == '-')
+        {
+            std::cerr << "usage: " << argv[0] << " --headless <frames>" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        GameEngine game("../config.txt", true);
+        game.runHeadless(static_cast<size_t>(frames));
+        return 0;
+    }
+
     GameEngine game("../config.txt");
     game.run();
     return 0;
@@ -0,0 +1,57 @@
+#include "SpatialGrid.h"
+#include <bit>
+
+
+SpatialGrid::SpatialGrid(float cellSize) : _cellSize(cellSize)
+{}
+
+void SpatialGrid::setCellSize(float cellSize)
+{
+	_cellSize = cellSize;
+}
+
+float SpatialGrid::getCellSize() const
+{
+	return _cellSize;
+}
+
+void SpatialGrid::clear()
+{
+	_items.clear();
+}
+
+uint32_t SpatialGrid::add(const Cells& cells)
+{
+	_items.push_back(cells);
+	return static_cast<uint32_t>(_items.size() - 1);
+}
+
+void SpatialGrid::build()
+{
+	size_t entries{ 0 };
+	for (const auto& c : _items)
+		entries += static_cast<size_t>(c.maxX - c.minX + 1) * static_cast<size_t>(c.maxY - c.minY + 1);
+
+	// about two buckets per entry keeps the chains short
+	const size_t buckets = std::bit_ceil(std::max<size_t>(entries * 2, 16));
+	_bucketMask = static_cast<uint32_t>(buckets - 1);
+	_cellStart.assign(buckets + 1, 0);
+	_cellEntries.resize(entries);
+
+	// counting sort, count each bucket then place the entries
+	for (const auto& c : _items)
+		for (int32_t y{ c.minY }; y <= c.maxY; ++y)
+			for (int32_t x{ c.minX }; x <= c.maxX; ++x)
+				_cellStart[bucketOf(x, y) + 1]++;
+
+	for (size_t i{ 1 }; i <= buckets; ++i)
+		_cellStart[i] += _cellStart[i - 1];
+
+	_cellFill.assign(_cellStart.begin(), _cellStart.end() - 1);
+	for (uint32_t i{ 0 }; i < _items.size(); ++i) {
+		const auto& c = _items[i];
+		for (int32_t y{ c.minY }; y <= c.maxY; ++y)
+			for (int32_t x{ c.minX }; x <= c.maxX; ++x)
+				_cellEntries[_cellFill[bucketOf(x, y)]++] = CellEntry{ i, x, y };
+	}
+}
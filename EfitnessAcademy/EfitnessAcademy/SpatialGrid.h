@@ -0,0 +1,94 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+
+// Uniform grid keyed by a hash of the cell coordinates
+//  items are added as the range of cells they cover and known by the order they
+//  were added in. build() places them in buckets with a counting sort, so a
+//  rebuild is linear in the entries. An item larger than a cell is stored in
+//  every cell it covers, isFirstShared picks the one cell in which a pair or a
+//  query reports it, so it is reported once.
+class SpatialGrid
+{
+public:
+	struct Cells {
+		int32_t			minX, minY, maxX, maxY;
+	};
+
+private:
+	struct CellEntry {
+		uint32_t		item;
+		int32_t			x, y;
+	};
+
+	float							_cellSize;
+	std::vector<Cells>				_items;
+	std::vector<uint32_t>			_cellStart;		// bucket -> first entry, one extra at the end
+	std::vector<uint32_t>			_cellFill;		// next free entry per bucket while building
+	std::vector<CellEntry>			_cellEntries;
+	uint32_t						_bucketMask{ 0 };
+
+	inline uint32_t	bucketOf(int32_t x, int32_t y) const {
+		return ((static_cast<uint32_t>(x) * 73856093u) ^ (static_cast<uint32_t>(y) * 19349663u)) & _bucketMask;
+	}
+
+public:
+	explicit SpatialGrid(float cellSize);
+
+	void			setCellSize(float cellSize);
+	float			getCellSize() const;
+
+	inline int32_t	cellOf(float v) const {
+		return static_cast<int32_t>(std::floor(v / _cellSize));
+	}
+
+	// the cells from the one holding min to the one holding max
+	inline Cells	cellsOf(sf::Vector2f min, sf::Vector2f max) const {
+		return Cells{ cellOf(min.x), cellOf(min.y), cellOf(max.x), cellOf(max.y) };
+	}
+
+	// drop every item, the memory is kept for the next build
+	void			clear();
+	uint32_t		add(const Cells& cells);
+	void			build();
+
+	size_t			size() const { return _items.size(); }
+	const Cells&	cells(uint32_t item) const { return _items[item]; }
+
+	// true in the first cell a and b share, the only one a pair is reported from
+	static bool		isFirstShared(const Cells& a, const Cells& b, int32_t x, int32_t y) {
+		return std::max(a.minX, b.minX) == x && std::max(a.minY, b.minY) == y;
+	}
+
+	// fn(item) for every item stored in cell (x, y)
+	template<typename Fn>
+	void			forEachIn(int32_t x, int32_t y, Fn&& fn) const {
+		const uint32_t bucket = bucketOf(x, y);
+		for (uint32_t k{ _cellStart[bucket] }; k < _cellStart[bucket + 1]; ++k) {
+			const auto& entry = _cellEntries[k];
+			if (entry.x == x && entry.y == y)
+				fn(entry.item);
+		}
+	}
+
+	// fn(item) once for every item covering one of area's cells, in cell order
+	template<typename Fn>
+	void			query(const Cells& area, Fn&& fn) const {
+		if (_items.empty())
+			return;
+
+		for (int32_t y{ area.minY }; y <= area.maxY; ++y) {
+			for (int32_t x{ area.minX }; x <= area.maxX; ++x) {
+				forEachIn(x, y, [&](uint32_t item) {
+					if (isFirstShared(_items[item], area, x, y))
+						fn(item);
+				});
+			}
+		}
+	}
+};
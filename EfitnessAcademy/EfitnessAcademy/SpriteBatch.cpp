@@ -0,0 +1,103 @@
+#include "SpriteBatch.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+
+void SpriteBatch::clear()
+{
+	_items.clear();
+	_quads.clear();
+}
+
+void SpriteBatch::add(const sf::Sprite& sprite, int layer)
+{
+	// a texture still waiting for its upload has nothing to draw yet
+	if (!sprite.getTexture() || !sprite.getTexture()->getNativeHandle())
+		return;
+	addQuad(sprite.getTexture(), sprite.getTextureRect(), sprite.getTransform(), sprite.getColor(), layer);
+}
+
+void SpriteBatch::add(const CSprite& sprite, const CTransform& tfm)
+{
+	if (!sprite.sprite.getTexture() || !sprite.sprite.getTexture()->getNativeHandle())
+		return;
+
+	// the sprite's own origin and scale, the entity's position and angle
+	sf::Transform transform;
+	transform.translate(tfm.pos)
+		.rotate(tfm.angle)
+		.scale(sprite.sprite.getScale())
+		.translate(-sprite.sprite.getOrigin());
+
+	addQuad(sprite.sprite.getTexture(), sprite.sprite.getTextureRect(), transform, sprite.sprite.getColor(), sprite.layer);
+}
+
+void SpriteBatch::addQuad(const sf::Texture* texture, const sf::IntRect& rect,
+	const sf::Transform& transform, sf::Color color, int layer)
+{
+	const float w = static_cast<float>(std::abs(rect.width));
+	const float h = static_cast<float>(std::abs(rect.height));
+	const float left = static_cast<float>(rect.left);
+	const float right = left + rect.width;
+	const float top = static_cast<float>(rect.top);
+	const float bottom = top + rect.height;
+
+	Quad quad;
+	quad.v[0] = sf::Vertex(transform.transformPoint(0.f, 0.f), color, sf::Vector2f(left, top));
+	quad.v[1] = sf::Vertex(transform.transformPoint(w, 0.f), color, sf::Vector2f(right, top));
+	quad.v[2] = sf::Vertex(transform.transformPoint(w, h), color, sf::Vector2f(right, bottom));
+	quad.v[3] = sf::Vertex(transform.transformPoint(0.f, h), color, sf::Vector2f(left, bottom));
+
+	_items.push_back(Item{ layer, texture, static_cast<uint32_t>(_quads.size()) });
+	_quads.push_back(quad);
+}
+
+void SpriteBatch::draw(sf::RenderTarget& target)
+{
+	std::stable_sort(_items.begin(), _items.end(), [](const Item& a, const Item& b) {
+		if (a.layer != b.layer)
+			return a.layer < b.layer;
+		return std::less<const sf::Texture*>()(a.texture, b.texture);
+	});
+
+	// one batch per run of items with the same layer and texture
+	_batchCount = 0;
+	for (size_t i{ 0 }; i < _items.size(); ) {
+		if (_batchCount == _batches.size())
+			_batches.emplace_back();
+		auto& batch = _batches[_batchCount++];
+		batch.texture = _items[i].texture;
+
+		size_t end{ i };
+		while (end < _items.size() && _items[end].layer == _items[i].layer && _items[end].texture == _items[i].texture)
+			++end;
+
+		batch.vertices.resize((end - i) * 6);
+		for (size_t k{ 0 }; i < end; ++i, k += 6) {
+			const auto& quad = _quads[_items[i].index];
+			batch.vertices[k + 0] = quad.v[0];
+			batch.vertices[k + 1] = quad.v[1];
+			batch.vertices[k + 2] = quad.v[2];
+			batch.vertices[k + 3] = quad.v[0];
+			batch.vertices[k + 4] = quad.v[2];
+			batch.vertices[k + 5] = quad.v[3];
+		}
+	}
+
+	for (size_t i{ 0 }; i < _batchCount; ++i)
+		target.draw(_batches[i].vertices, sf::RenderStates(_batches[i].texture));
+
+	_drawCalls = _batchCount;
+	clear();
+}
+
+size_t SpriteBatch::spriteCount() const
+{
+	return _items.size();
+}
+
+size_t SpriteBatch::drawCalls() const
+{
+	return _drawCalls;
+}
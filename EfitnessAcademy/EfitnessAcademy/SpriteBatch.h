@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Components.h"
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+
+// Batched sprite renderer
+//  sprites are collected for the frame, sorted by layer then texture and
+//  written as two triangles each into one vertex array per (layer, texture),
+//  so a layer costs one draw call per texture instead of one per sprite.
+//  Layers draw in ascending order. Within a layer, sprites of the same texture
+//  keep their submission order, sprites of different textures do not overlap
+//  predictably. The vertex arrays are kept between frames.
+class SpriteBatch
+{
+private:
+	struct Item {
+		int					layer;
+		const sf::Texture*	texture;
+		uint32_t			index;		// into _quads
+	};
+
+	struct Quad {
+		sf::Vertex			v[4];		// top-left, top-right, bottom-right, bottom-left
+	};
+
+	struct Batch {
+		const sf::Texture*	texture{ nullptr };
+		sf::VertexArray		vertices{ sf::Triangles };
+	};
+
+	std::vector<Item>		_items;
+	std::vector<Quad>		_quads;
+	std::vector<Batch>		_batches;
+	size_t					_batchCount{ 0 };
+	size_t					_drawCalls{ 0 };
+
+	void					addQuad(const sf::Texture* texture, const sf::IntRect& rect,
+		const sf::Transform& transform, sf::Color color, int layer);
+
+public:
+	void					clear();
+
+	// the sprite as it is, with its own transform
+	void					add(const sf::Sprite& sprite, int layer = 0);
+
+	// a CSprite placed at its entity's CTransform
+	void					add(const CSprite& sprite, const CTransform& tfm);
+
+	// sort, build the vertex arrays and draw them, then clear
+	void					draw(sf::RenderTarget& target);
+
+	size_t					spriteCount() const;
+	size_t					drawCalls() const;		// of the last draw()
+};
@@ -0,0 +1,72 @@
+#include "SystemScheduler.h"
+#include "Profiler.h"
+#include <algorithm>
+
+
+bool SystemAccess::conflictsWith(const SystemAccess& other) const
+{
+	return exclusive || other.exclusive
+		|| (writes & (other.reads | other.writes)) != 0
+		|| (other.writes & (reads | writes)) != 0;
+}
+
+void SystemScheduler::add(const std::string& name, SystemAccess access, SystemFn fn)
+{
+#if EFA_PROFILE
+	const char* profileName = Profiler::getInstance().intern(name);
+#else
+	const char* profileName = nullptr;
+#endif
+	_systems.push_back(System{ name, access, std::move(fn), profileName });
+	buildStages();
+}
+
+void SystemScheduler::buildStages()
+{
+	_stages.clear();
+	std::vector<size_t> stageOf(_systems.size(), 0);
+
+	for (size_t i{ 0 }; i < _systems.size(); ++i) {
+		size_t stage{ 0 };
+		for (size_t j{ 0 }; j < i; ++j)
+			if (_systems[i].access.conflictsWith(_systems[j].access))
+				stage = std::max(stage, stageOf[j] + 1);
+
+		stageOf[i] = stage;
+		if (stage >= _stages.size())
+			_stages.resize(stage + 1);
+		_stages[stage].push_back(i);
+	}
+}
+
+void SystemScheduler::run(JobSystem& jobs, sf::Time dt)
+{
+	for (const auto& stage : _stages) {
+		if (stage.size() == 1) {
+			const auto& system = _systems[stage.front()];
+			PROFILE_SCOPE(system.profileName);
+			system.fn(dt);
+			continue;
+		}
+
+		JobCounter counter;
+		for (size_t i : stage) {
+			auto& system = _systems[i];
+			jobs.submit([&system, dt]() {
+				PROFILE_SCOPE(system.profileName);
+				system.fn(dt);
+			}, counter);
+		}
+		jobs.wait(counter);
+	}
+}
+
+size_t SystemScheduler::systemCount() const
+{
+	return _systems.size();
+}
+
+size_t SystemScheduler::stageCount() const
+{
+	return _stages.size();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Entity.h"
+#include "JobSystem.h"
+#include <SFML/System.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+// component access a system declares when it is registered
+template<typename... Ts>
+struct Reads {};
+
+template<typename... Ts>
+struct Writes {};
+
+struct SystemAccess
+{
+	Signature	reads{ 0 };
+	Signature	writes{ 0 };
+	bool		exclusive{ false };		// runs alone, may add or remove entities and components
+
+	bool		conflictsWith(const SystemAccess& other) const;
+};
+
+using SystemFn = std::function<void(sf::Time)>;
+
+
+// Runs a scene's systems
+//  systems are grouped into stages. A system goes in the stage after the last
+//  earlier system it conflicts with (one writes what the other reads or
+//  writes), so the systems of a stage can run in parallel and the result is the
+//  same as running everything serially in registration order.
+class SystemScheduler
+{
+private:
+	struct System {
+		std::string		name;
+		SystemAccess	access;
+		SystemFn		fn;
+		const char*		profileName;	// interned, the profiler may outlive the scene, null when compiled out
+	};
+
+	std::vector<System>					_systems;
+	std::vector<std::vector<size_t>>	_stages;
+
+	void				buildStages();
+
+public:
+	void				add(const std::string& name, SystemAccess access, SystemFn fn);
+	void				run(JobSystem& jobs, sf::Time dt);
+
+	size_t				systemCount() const;
+	size_t				stageCount() const;
+};
@@ -0,0 +1,34 @@
+#include "TextCache.h"
+#include <functional>
+
+
+size_t TextCache::KeyHash::operator()(const KeyView& k) const
+{
+	size_t h = std::hash<std::string_view>()(k.string);
+	h ^= std::hash<const void*>()(k.font) + 0x9e3779b9 + (h << 6) + (h >> 2);
+	h ^= (static_cast<size_t>(k.size) << 8 | k.style) + 0x9e3779b9 + (h << 6) + (h >> 2);
+	return h;
+}
+
+sf::Text& TextCache::get(const sf::Font& font, unsigned int size, std::string_view string, sf::Uint32 style)
+{
+	auto found = _texts.find(KeyView{ &font, size, style, string });
+	if (found != _texts.end())
+		return *found->second;
+
+	auto text = std::make_unique<sf::Text>(sf::String(std::string(string)), font, size);
+	text->setStyle(style);
+	text->getLocalBounds();		// builds the geometry, copies of a text that was never drawn would each rebuild it
+	auto rc = _texts.emplace(Key{ &font, size, style, std::string(string) }, std::move(text));
+	return *rc.first->second;
+}
+
+size_t TextCache::size() const
+{
+	return _texts.size();
+}
+
+void TextCache::clear()
+{
+	_texts.clear();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+
+// Retained text
+//  one sf::Text per (font, size, style, string), built the first time it is
+//  asked for and kept. Its glyph geometry is built then too, SFML only rebuilds
+//  it when the string, font, size or style change, which a cached text never
+//  does. The RenderQueue draws copies, which carry the built geometry, so the
+//  cached text itself is never drawn. Position and colour are set per use and
+//  cost no rebuild. Looking a string up does not allocate.
+class TextCache
+{
+private:
+	struct KeyView {
+		const sf::Font*		font;
+		unsigned int		size;
+		sf::Uint32			style;
+		std::string_view	string;
+	};
+
+	struct Key {
+		const sf::Font*		font;
+		unsigned int		size;
+		sf::Uint32			style;
+		std::string			string;
+
+		operator KeyView() const { return KeyView{ font, size, style, string }; }
+	};
+
+	struct KeyHash {
+		using is_transparent = void;
+		size_t operator()(const KeyView& k) const;
+		size_t operator()(const Key& k) const { return (*this)(KeyView(k)); }
+	};
+
+	struct KeyEqual {
+		using is_transparent = void;
+		bool operator()(const KeyView& a, const KeyView& b) const {
+			return a.font == b.font && a.size == b.size && a.style == b.style && a.string == b.string;
+		}
+	};
+
+	// unique_ptr so a returned sf::Text& survives the map growing
+	std::unordered_map<Key, std::unique_ptr<sf::Text>, KeyHash, KeyEqual>	_texts;
+
+public:
+	sf::Text&		get(const sf::Font& font, unsigned int size, std::string_view string,
+		sf::Uint32 style = sf::Text::Regular);
+
+	size_t			size() const;
+	void			clear();
+};
@@ -0,0 +1,400 @@
+#include "TextureAtlas.h"
+#include "Utilities.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+
+namespace {
+	int right(const sf::IntRect& r) { return r.left + r.width; }
+	int bottom(const sf::IntRect& r) { return r.top + r.height; }
+
+	bool contains(const sf::IntRect& outer, const sf::IntRect& inner)
+	{
+		return inner.left >= outer.left && inner.top >= outer.top
+			&& right(inner) <= right(outer) && bottom(inner) <= bottom(outer);
+	}
+
+	// smallest rect holding every pixel with alpha, 1x1 for a fully transparent image
+	sf::IntRect opaqueBounds(const sf::Image& image)
+	{
+		const sf::Vector2u size = image.getSize();
+		const sf::Uint8* pixels = image.getPixelsPtr();
+		unsigned int minX{ size.x }, minY{ size.y }, maxX{ 0 }, maxY{ 0 };
+
+		for (unsigned int y{ 0 }; y < size.y; ++y) {
+			for (unsigned int x{ 0 }; x < size.x; ++x) {
+				if (pixels[(y * size.x + x) * 4 + 3] == 0)
+					continue;
+				minX = std::min(minX, x);
+				minY = std::min(minY, y);
+				maxX = std::max(maxX, x);
+				maxY = std::max(maxY, y);
+			}
+		}
+
+		if (minX > maxX)
+			return { 0, 0, 1, 1 };
+		return { static_cast<int>(minX), static_cast<int>(minY),
+			static_cast<int>(maxX - minX + 1), static_cast<int>(maxY - minY + 1) };
+	}
+}
+
+
+MaxRectsPacker::MaxRectsPacker(sf::Vector2i size)
+{
+	reset(size);
+}
+
+void MaxRectsPacker::reset(sf::Vector2i size)
+{
+	_free.clear();
+	if (size.x > 0 && size.y > 0)
+		_free.push_back({ 0, 0, size.x, size.y });
+}
+
+bool MaxRectsPacker::insert(sf::Vector2i size, sf::IntRect& placed)
+{
+	int bestShort{ std::numeric_limits<int>::max() };
+	int bestLong{ std::numeric_limits<int>::max() };
+	bool found{ false };
+
+	for (const auto& f : _free) {
+		if (f.width < size.x || f.height < size.y)
+			continue;
+
+		const int leftoverX = f.width - size.x;
+		const int leftoverY = f.height - size.y;
+		const int shortSide = std::min(leftoverX, leftoverY);
+		const int longSide = std::max(leftoverX, leftoverY);
+		if (shortSide < bestShort || (shortSide == bestShort && longSide < bestLong)) {
+			placed = { f.left, f.top, size.x, size.y };
+			bestShort = shortSide;
+			bestLong = longSide;
+			found = true;
+		}
+	}
+
+	if (!found)
+		return false;
+
+	split(placed);
+	prune();
+	return true;
+}
+
+void MaxRectsPacker::split(const sf::IntRect& used)
+{
+	std::vector<sf::IntRect> next;
+	next.reserve(_free.size() + 4);
+
+	for (const auto& f : _free) {
+		if (!f.intersects(used)) {
+			next.push_back(f);
+			continue;
+		}
+
+		// the up to four maximal pieces of f around used
+		if (used.left > f.left)
+			next.push_back({ f.left, f.top, used.left - f.left, f.height });
+		if (right(used) < right(f))
+			next.push_back({ right(used), f.top, right(f) - right(used), f.height });
+		if (used.top > f.top)
+			next.push_back({ f.left, f.top, f.width, used.top - f.top });
+		if (bottom(used) < bottom(f))
+			next.push_back({ f.left, bottom(used), f.width, bottom(f) - bottom(used) });
+	}
+	_free.swap(next);
+}
+
+void MaxRectsPacker::prune()
+{
+	for (size_t i{ 0 }; i < _free.size(); ++i) {
+		for (size_t j{ i + 1 }; j < _free.size(); ) {
+			if (contains(_free[i], _free[j])) {
+				_free.erase(_free.begin() + j);
+			}
+			else if (contains(_free[j], _free[i])) {
+				_free.erase(_free.begin() + i);
+				j = i + 1;
+			}
+			else {
+				++j;
+			}
+		}
+	}
+}
+
+
+TextureAtlas::TextureAtlas(AtlasSettings settings)
+	: _settings(std::move(settings))
+{}
+
+void TextureAtlas::addSource(const std::string& name, const std::string& path, std::string_view memory)
+{
+	auto found = std::find_if(_sources.begin(), _sources.end(), [&name](const Source& s) { return s.name == name; });
+	if (found != _sources.end()) {
+		found->path = path;
+		found->memory = memory;
+	}
+	else
+		_sources.push_back({ name, path, memory });
+}
+
+const AtlasEntry* TextureAtlas::find(const std::string& name) const
+{
+	auto found = _entries.find(name);
+	return found == _entries.end() ? nullptr : &found->second;
+}
+
+std::vector<std::pair<std::string, std::string>> TextureAtlas::dropPage(size_t page)
+{
+	std::vector<std::pair<std::string, std::string>> dropped;
+	for (const auto& src : _sources) {
+		auto found = _entries.find(src.name);
+		if (found != _entries.end() && found->second.page == page) {
+			dropped.emplace_back(src.name, src.path);
+			_entries.erase(found);
+		}
+	}
+	return dropped;
+}
+
+std::string TextureAtlas::pageName(size_t page)
+{
+	return "atlas:" + std::to_string(page);
+}
+
+std::string TextureAtlas::signature() const
+{
+	std::ostringstream os;
+	os << "Params " << _settings.pageSize << " " << _settings.padding << " " << _settings.trim << "\n";
+
+	for (const auto& src : _sources) {
+		// a bundled source has no file to date, its contents stand in for the time
+		if (src.memory.data()) {
+			os << "Source " << src.name << " " << src.path << " " << src.memory.size() << " "
+				<< hashString(src.memory) << "\n";
+			continue;
+		}
+
+		std::error_code sizeError, timeError;
+		const auto size = std::filesystem::file_size(src.path, sizeError);
+		const auto time = std::filesystem::last_write_time(src.path, timeError);
+		os << "Source " << src.name << " " << src.path << " "
+			<< (sizeError ? 0 : size) << " " << (timeError ? 0 : time.time_since_epoch().count()) << "\n";
+	}
+	return os.str();
+}
+
+bool TextureAtlas::loadCache()
+{
+	std::ifstream confFile(_settings.cachePath + ".txt");
+	if (confFile.fail())
+		return false;
+
+	// stale unless the header matches what we would pack now
+	const std::string expected = signature();
+	std::string header(expected.size(), '\0');
+	confFile.read(header.data(), static_cast<std::streamsize>(header.size()));
+	if (!confFile || header != expected)
+		return false;
+
+	std::map<std::string, AtlasEntry> entries;
+	std::vector<std::string> skipped;
+	size_t pages{ 0 };
+
+	std::string token{ "" };
+	confFile >> token;
+	while (confFile) {
+		if (token == "Pages") {
+			confFile >> pages;
+		}
+		else if (token == "Entry") {
+			std::string name;
+			AtlasEntry e;
+			confFile >> name >> e.page >> e.rect.left >> e.rect.top >> e.rect.width >> e.rect.height
+				>> e.trim.x >> e.trim.y >> e.sourceSize.x >> e.sourceSize.y;
+			entries[name] = e;
+		}
+		else if (token == "Skipped") {
+			std::string name;
+			confFile >> name;
+			skipped.push_back(name);
+		}
+		else {
+			// ignore rest of line and continue
+			std::string buffer;
+			std::getline(confFile, buffer);
+		}
+		confFile >> token;
+	}
+
+	// the signature dates every source, a skipped one stays skipped until its file changes
+	if (entries.size() + skipped.size() != _sources.size())
+		return false;
+
+	std::vector<sf::Image> images(pages);
+	for (size_t i{ 0 }; i < pages; ++i) {
+		if (!images[i].loadFromFile(_settings.cachePath + "_" + std::to_string(i) + ".png"))
+			return false;
+	}
+
+	for (const auto& src : _sources) {
+		if (std::find(skipped.begin(), skipped.end(), src.name) != skipped.end())
+			std::cerr << "Left out of the atlas: " << src.path << std::endl;
+	}
+
+	_entries.swap(entries);
+	_pages.swap(images);
+	return true;
+}
+
+void TextureAtlas::saveCache() const
+{
+	const std::filesystem::path cache(_settings.cachePath);
+	std::error_code ec;
+	if (cache.has_parent_path())
+		std::filesystem::create_directories(cache.parent_path(), ec);
+
+	for (size_t i{ 0 }; i < _pages.size(); ++i) {
+		const std::string path = _settings.cachePath + "_" + std::to_string(i) + ".png";
+		if (!_pages[i].saveToFile(path)) {
+			std::cerr << "Could not write atlas page: " << path << std::endl;
+			return;
+		}
+	}
+
+	// the index goes last, a half written cache never looks valid
+	std::ofstream out(_settings.cachePath + ".txt");
+	if (out.fail()) {
+		std::cerr << "Open file " << _settings.cachePath << ".txt failed\n";
+		return;
+	}
+	out << signature();
+	out << "Pages " << _pages.size() << "\n";
+	for (const auto& [name, e] : _entries) {
+		out << "Entry " << name << " " << e.page << " "
+			<< e.rect.left << " " << e.rect.top << " " << e.rect.width << " " << e.rect.height << " "
+			<< e.trim.x << " " << e.trim.y << " " << e.sourceSize.x << " " << e.sourceSize.y << "\n";
+	}
+	for (const auto& src : _sources) {
+		if (!_entries.count(src.name))
+			out << "Skipped " << src.name << "\n";
+	}
+}
+
+void TextureAtlas::pack(JobSystem* jobs)
+{
+	const int pageSize = static_cast<int>(_settings.pageSize);
+	const int padding = static_cast<int>(_settings.padding);
+
+	std::vector<sf::Image> images(_sources.size());
+	std::vector<sf::IntRect> bounds(_sources.size());
+	std::vector<char> loaded(_sources.size(), 0);
+	auto decode = [&](size_t begin, size_t end) {
+		for (size_t i{ begin }; i < end; ++i) {
+			const auto& src = _sources[i];
+			loaded[i] = src.memory.data() ? images[i].loadFromMemory(src.memory.data(), src.memory.size())
+				: images[i].loadFromFile(src.path);
+			if (loaded[i] && _settings.trim)
+				bounds[i] = opaqueBounds(images[i]);
+		}
+	};
+	if (jobs)
+		jobs->parallelFor(_sources.size(), 1, decode);
+	else
+		decode(0, _sources.size());
+
+	// a source that fails is left out, like a Texture line that fails to load
+	std::vector<size_t> order;
+	for (size_t i{ 0 }; i < _sources.size(); ++i) {
+		if (!loaded[i]) {
+			std::cerr << "Could not load texture file: " << _sources[i].path << std::endl;
+			continue;
+		}
+
+		const sf::Vector2u size = images[i].getSize();
+		if (!_settings.trim)
+			bounds[i] = sf::IntRect(0, 0, static_cast<int>(size.x), static_cast<int>(size.y));
+		if (bounds[i].width > pageSize || bounds[i].height > pageSize) {
+			std::cerr << "Atlas page too small for " << _sources[i].path << std::endl;
+			continue;
+		}
+		order.push_back(i);
+	}
+
+	// largest first packs tightest, names break ties so a rebuild gives the same layout
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		const int sideA = std::max(bounds[a].width, bounds[a].height);
+		const int sideB = std::max(bounds[b].width, bounds[b].height);
+		if (sideA != sideB)
+			return sideA > sideB;
+		const int areaA = bounds[a].width * bounds[a].height;
+		const int areaB = bounds[b].width * bounds[b].height;
+		if (areaA != areaB)
+			return areaA > areaB;
+		return _sources[a].name < _sources[b].name;
+	});
+
+	// padding goes right and below each entry, the packed area grows by it so the last one can touch the edge
+	std::vector<MaxRectsPacker> packers;
+	std::vector<sf::Vector2i> extents;
+	std::map<std::string, AtlasEntry> entries;
+
+	for (const size_t i : order) {
+		const sf::Vector2i padded{ bounds[i].width + padding, bounds[i].height + padding };
+
+		AtlasEntry e;
+		sf::IntRect placed;
+		for (e.page = 0; e.page < packers.size(); ++e.page) {
+			if (packers[e.page].insert(padded, placed))
+				break;
+		}
+		if (e.page == packers.size()) {
+			packers.emplace_back(sf::Vector2i{ pageSize + padding, pageSize + padding });
+			extents.push_back({ 0, 0 });
+			packers.back().insert(padded, placed);
+		}
+
+		const sf::Vector2u size = images[i].getSize();
+		e.rect = { placed.left, placed.top, bounds[i].width, bounds[i].height };
+		e.trim = { bounds[i].left, bounds[i].top };
+		e.sourceSize = { static_cast<int>(size.x), static_cast<int>(size.y) };
+		extents[e.page].x = std::max(extents[e.page].x, right(e.rect));
+		extents[e.page].y = std::max(extents[e.page].y, bottom(e.rect));
+		entries[_sources[i].name] = e;
+	}
+
+	// pages are cropped to what they use
+	std::vector<sf::Image> pages(packers.size());
+	for (size_t p{ 0 }; p < pages.size(); ++p)
+		pages[p].create(extents[p].x, extents[p].y, sf::Color::Transparent);
+
+	for (const size_t i : order) {
+		const AtlasEntry& e = entries[_sources[i].name];
+		pages[e.page].copy(images[i], e.rect.left, e.rect.top, bounds[i]);
+	}
+
+	_entries.swap(entries);
+	_pages.swap(pages);
+}
+
+void TextureAtlas::build(JobSystem* jobs)
+{
+	if (!_settings.cachePath.empty() && loadCache()) {
+		std::cout << "Loaded texture atlas: " << _settings.cachePath << std::endl;
+		return;
+	}
+
+	pack(jobs);
+	std::cout << "Packed " << _entries.size() << " textures into " << _pages.size() << " atlas pages" << std::endl;
+
+	if (!_settings.cachePath.empty())
+		saveCache();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "JobSystem.h"
+#include <SFML/Graphics.hpp>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+// MaxRects bin packer, best short side fit
+//  keeps the maximal free rectangles of one page, every placement splits the
+//  free rectangles it overlaps and drops the ones contained in another
+class MaxRectsPacker
+{
+private:
+	std::vector<sf::IntRect>	_free;
+
+	void			split(const sf::IntRect& used);
+	void			prune();
+
+public:
+	explicit MaxRectsPacker(sf::Vector2i size = { 0, 0 });
+
+	void			reset(sf::Vector2i size);
+	bool			insert(sf::Vector2i size, sf::IntRect& placed);
+};
+
+
+struct AtlasEntry {
+	size_t			page{ 0 };
+	sf::IntRect		rect;				// packed, trimmed pixels on the page
+	sf::Vector2i	trim{ 0, 0 };		// pixels cut from the source's left and top
+	sf::Vector2i	sourceSize{ 0, 0 };	// the source before trimming
+
+	// where the source's pixel (0, 0) lands on the page, sub-rects are relative to it
+	sf::Vector2i	origin() const { return { rect.left - trim.x, rect.top - trim.y }; }
+};
+
+
+struct AtlasSettings {
+	unsigned int	pageSize{ 2048 };
+	unsigned int	padding{ 2 };		// transparent pixels between entries, keeps filtering from bleeding
+	bool			trim{ false };		// cut transparent borders, sub-rects reaching into them are clipped
+	std::string		cachePath;			// "" = pack every run, otherwise <cachePath>.txt and <cachePath>_<n>.png
+};
+
+
+// Texture atlas
+//  packs many source images into a few large pages so sprites from different
+//  files share a texture and batch into one draw. The layout and the page images
+//  can be cached on disk, the cache is reused while the settings and every
+//  source's path, size and modification time match.
+class TextureAtlas
+{
+private:
+	struct Source {
+		std::string		name;
+		std::string		path;
+		std::string_view	memory;		// a bundle blob, used instead of path when set
+	};
+
+	AtlasSettings						_settings;
+	std::vector<Source>					_sources;
+	std::map<std::string, AtlasEntry>	_entries;
+	std::vector<sf::Image>				_pages;
+
+	std::string		signature() const;
+	bool			loadCache();
+	void			saveCache() const;
+	void			pack(JobSystem* jobs);
+
+public:
+	explicit TextureAtlas(AtlasSettings settings = {});
+
+	// memory is the encoded file, it has to stay valid until build returns
+	void			addSource(const std::string& name, const std::string& path, std::string_view memory = {});
+
+	// packs the sources, or loads the cached result. A source that fails to load or does not
+	//  fit a page is reported and left out. With jobs the sources are decoded in parallel, no GL
+	//  context is needed
+	void			build(JobSystem* jobs = nullptr);
+
+	size_t								pageCount() const { return _pages.size(); }
+	const sf::Image&					pageImage(size_t page) const { return _pages.at(page); }
+	const std::map<std::string, AtlasEntry>& entries() const { return _entries; }
+
+	// nullptr when name was not packed
+	const AtlasEntry*	find(const std::string& name) const;
+
+	// leaves out every entry on a page that could not be used, gives their names and paths
+	std::vector<std::pair<std::string, std::string>>	dropPage(size_t page);
+
+	static std::string	pageName(size_t page);
+};
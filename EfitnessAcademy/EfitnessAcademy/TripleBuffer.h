@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+
+// Lock-free triple buffer, one producer thread and one consumer thread
+//  the producer fills back() and publish()es it, the consumer acquire()s the
+//  newest published slot and reads front(). Neither side ever waits, the
+//  producer overwrites a slot the consumer has not picked up yet.
+template<typename T>
+class TripleBuffer
+{
+private:
+	static constexpr uint8_t IndexMask{ 0x3 };
+	static constexpr uint8_t Fresh{ 0x4 };		// set when the middle slot has not been acquired
+
+	T						_slots[3];
+	std::atomic<uint8_t>	_middle{ 1 };
+	uint8_t					_back{ 0 };			// producer only
+	uint8_t					_front{ 2 };		// consumer only
+
+public:
+	T&			back() { return _slots[_back]; }
+	const T&	front() const { return _slots[_front]; }
+
+	// hand back() to the consumer and take the old middle slot to fill next
+	void		publish() {
+		_back = _middle.exchange(_back | Fresh, std::memory_order_acq_rel) & IndexMask;
+	}
+
+	// false if nothing was published since the last acquire, front() is unchanged
+	bool		acquire() {
+		if ((_middle.load(std::memory_order_relaxed) & Fresh) == 0)
+			return false;
+		_front = _middle.exchange(_front, std::memory_order_acq_rel) & IndexMask;
+		return true;
+	}
+};
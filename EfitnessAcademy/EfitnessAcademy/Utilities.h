@@ -8,6 +8,8 @@
 
 #include <SFML/Graphics.hpp>
 #include <iostream>
+#include <string_view>
+#include <cstdint>
 
 
 
@@ -21,6 +23,17 @@ float           dist(const sf::Vector2f& u, const sf::Vector2f& v);
 float radToDeg(float r);
 float degToRad(float d);
 
+
+// 64 bit FNV-1a, constexpr so names known at compile time hash for free
+constexpr std::uint64_t hashString(std::string_view s) {
+    std::uint64_t h{ 14695981039346656037ull };
+    for (char c : s) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
 template<typename T>
 inline void centerOrigin(T& t) {
     auto bounds = t.getLocalBounds();
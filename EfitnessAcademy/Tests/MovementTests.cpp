@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// MovementSystem tests
+//  the SSE and AVX2 integrate kernels against the scalar one, bit for bit, and
+//  MovementSystem::update against a plain integration of every CTransform.
+//  Exits non-zero if a check fails
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "MovementSystem.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+namespace {
+
+    int g_failures{ 0 };
+
+    void check(bool ok, const char* what, size_t a = 0, size_t b = 0)
+    {
+        if (ok)
+            return;
+        ++g_failures;
+        std::printf("FAILED %s (%zu, %zu)\n", what, a, b);
+    }
+
+    bool sameBits(const float* a, const float* b, size_t n)
+    {
+        return std::memcmp(a, b, n * sizeof(float)) == 0;
+    }
+
+    // every length from 0 to 33 at every start offset into an aligned buffer, the
+    // kernels must match the scalar one and leave the floats around the range alone
+    void testKernel(const char* name, IntegrateKernel kernel)
+    {
+        constexpr size_t MaxCount{ 33 };
+        constexpr size_t MaxOffset{ 8 };
+        constexpr size_t Size{ MaxOffset + MaxCount + 8 };
+
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> value(-1000.f, 1000.f);
+        const float dts[] = { 1.f / 60.f, 1.f / 144.f, 0.25f };
+
+        FloatLanes values(Size), rates(Size), expected(Size), actual(Size);
+        size_t cases{ 0 };
+        for (const float dt : dts) {
+            for (size_t count{ 0 }; count <= MaxCount; ++count) {
+                for (size_t offset{ 0 }; offset < MaxOffset; ++offset) {
+                    for (size_t i{ 0 }; i < Size; ++i) {
+                        values[i] = value(rng);
+                        rates[i] = value(rng);
+                    }
+                    expected = values;
+                    actual = values;
+                    kernels::integrateScalar(expected.data() + offset, rates.data() + offset, count, dt);
+                    kernel(actual.data() + offset, rates.data() + offset, count, dt);
+
+                    check(sameBits(expected.data(), actual.data(), Size), name, count, offset);
+                    ++cases;
+                }
+            }
+        }
+        std::printf("%s: %zu cases\n", name, cases);
+    }
+
+    bool avx2Supported()
+    {
+        return kernels::integrate() == &kernels::integrateAvx2;
+    }
+
+    // what update has to produce, step first then add, as the kernels do
+    CTransform integrated(CTransform t, float dt)
+    {
+        t.prevPos = t.pos;
+        const sf::Vector2f step{ t.vel.x * dt, t.vel.y * dt };
+        const float turn = t.angVel * dt;
+        t.pos.x = t.pos.x + step.x;
+        t.pos.y = t.pos.y + step.y;
+        t.angle = t.angle + turn;
+        return t;
+    }
+
+    // counts around the job grain and the 8 float padding
+    void testUpdate(JobSystem* jobs, size_t count)
+    {
+        std::mt19937 rng(static_cast<unsigned>(count));
+        std::uniform_real_distribution<float> value(-500.f, 500.f);
+
+        EntityManager entities;
+        entities.addEntities("mover", count);
+        entities.update();
+        for (const auto h : entities.getEntities()) {
+            auto& t = entities.get(h)->addComponent<CTransform>(sf::Vector2f{ value(rng), value(rng) },
+                sf::Vector2f{ value(rng), value(rng) });
+            t.angle = value(rng);
+            t.angVel = value(rng);
+        }
+
+        const sf::Time dt = sf::seconds(1.f / 60.f);
+        auto& pool = entities.getPool<CTransform>();
+        std::vector<CTransform> expected;
+        for (size_t i{ 0 }; i < pool.size(); ++i)
+            expected.push_back(integrated(pool.data()[i], dt.asSeconds()));
+
+        MovementSystem movement;
+        if (jobs)
+            movement.update(entities, *jobs, dt);
+        else
+            movement.update(entities, dt);
+
+        bool ok{ true };
+        for (size_t i{ 0 }; i < pool.size(); ++i) {
+            const CTransform& a = pool.data()[i];
+            const CTransform& e = expected[i];
+            ok = ok && sameBits(&a.pos.x, &e.pos.x, 1) && sameBits(&a.pos.y, &e.pos.y, 1)
+                && sameBits(&a.angle, &e.angle, 1) && a.prevPos == e.prevPos;
+        }
+        check(ok, jobs ? "MovementSystem::update, jobs" : "MovementSystem::update", count);
+    }
+}
+
+
+int main()
+{
+    std::printf("integrate kernel in use: %s\n", kernels::integrateName());
+
+    testKernel("integrateSse", &kernels::integrateSse);
+    if (avx2Supported())
+        testKernel("integrateAvx2", &kernels::integrateAvx2);
+    else
+        std::printf("integrateAvx2: skipped, this CPU has no AVX2\n");
+
+    JobSystem jobs;
+    for (const size_t count : { size_t{ 0 }, size_t{ 1 }, size_t{ 7 }, size_t{ 9 }, size_t{ 1000 }, size_t{ 4095 }, size_t{ 10000 } }) {
+        testUpdate(nullptr, count);
+        testUpdate(&jobs, count);
+    }
+    std::printf("MovementSystem::update: checked\n");
+
+    if (g_failures)
+        std::printf("%d checks failed\n", g_failures);
+    else
+        std::printf("all checks passed\n");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Asset bundle packer
+//  reads a game config and packs every Font, Texture and Sound file it names
+//  into one bundle, with a manifest of those lines and the Atlas, Sprite and
+//  Animation lines. Run it from the directory the game runs in, the paths in
+//  the config are relative to it and name the files inside the bundle.
+//  The game then only needs "Bundle <out>" in its config.
+//
+//  BundlePacker <config> <out.bundle>
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+#include "AssetBundle.h"
+#include "ConfigParser.h"
+
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3) {
+        std::cerr << "usage: BundlePacker <config> <out.bundle>\n";
+        return 2;
+    }
+
+    ConfigParser parser;
+    BundleWriter writer;
+    std::string manifest;
+    std::set<std::string> packed;
+    size_t failed{ 0 };
+
+    // Font, Texture and Sound lines name a file, pack it once however many lines use it
+    auto packFile = [&](std::string directive) {
+        return [&, directive](ConfigLine& line) {
+            const std::string name = line.read<std::string>("name");
+            const std::string path = line.read<std::string>("path");
+            if (packed.insert(path).second && !writer.addFile(path, path)) {
+                std::cerr << argv[1] << ":" << line.line() << ": could not read " << path << "\n";
+                packed.erase(path);
+                ++failed;
+                return;
+            }
+            manifest += directive + " " + name + " " + path + "\n";
+        };
+    };
+
+    // the rest go into the manifest as they are
+    auto copyLine = [&](std::string directive) {
+        return [&, directive](ConfigLine& line) {
+            manifest += directive;
+            while (!line.atEnd()) {
+                manifest += ' ';
+                manifest += line.next("argument");
+            }
+            manifest += '\n';
+        };
+    };
+
+    for (const char* directive : { "Font", "Texture", "Sound" })
+        parser.on(directive, packFile(directive));
+    for (const char* directive : { "Atlas", "Sprite", "Animation" })
+        parser.on(directive, copyLine(directive));
+
+    failed += parser.parseFile(argv[1]);
+    if (failed) {
+        std::cerr << failed << " lines failed, no bundle written\n";
+        return 1;
+    }
+
+    writer.add(std::string(bundle::ManifestName), std::vector<char>(manifest.begin(), manifest.end()));
+    if (!writer.write(argv[2])) {
+        std::cerr << "could not write " << argv[2] << "\n";
+        return 1;
+    }
+
+    AssetBundle check;
+    if (!check.open(argv[2])) {
+        std::cerr << argv[2] << " does not read back\n";
+        return 1;
+    }
+    std::cout << "Packed " << packed.size() << " files into " << argv[2] << "\n";
+    return 0;
+}